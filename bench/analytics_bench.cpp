@@ -0,0 +1,126 @@
+#include "simd_kernels.h"
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+// Сравнение векторных ядер аналитики со скалярной реализацией
+// на синтетических столбцах истории обслуживания
+
+namespace {
+
+    struct Dataset {
+        std::vector<int32_t> days;
+        std::vector<int32_t> devices;
+        std::vector<int32_t> services;
+        std::vector<int32_t> due_days;
+        std::vector<int64_t> costs;
+        std::vector<uint32_t> device_bitmap;
+    };
+
+    const Dataset& dataset(size_t rows) {
+        static std::vector<std::pair<size_t, Dataset>> cache;
+        for (const auto& entry : cache) {
+            if (entry.first == rows) {
+                return entry.second;
+            }
+        }
+
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int32_t> day(18000, 20500);
+        std::uniform_int_distribution<int32_t> device(1, 5000);
+        std::uniform_int_distribution<int32_t> service(1, 50);
+        std::uniform_int_distribution<int64_t> cost(500, 500000);
+
+        Dataset data;
+        for (size_t i = 0; i < rows; ++i) {
+            data.days.push_back(day(rng));
+            data.devices.push_back(device(rng));
+            data.services.push_back(service(rng));
+            data.due_days.push_back(i % 4 == 0 ? std::numeric_limits<int32_t>::min() : day(rng) + 180);
+            data.costs.push_back(cost(rng));
+        }
+
+        // Каждое десятое устройство
+        data.device_bitmap.assign(5001 / 32 + 1, 0);
+        for (int32_t id = 10; id <= 5000; id += 10) {
+            data.device_bitmap[id >> 5] |= 1u << (id & 31);
+        }
+
+        cache.emplace_back(rows, std::move(data));
+        return cache.back().second;
+    }
+
+    simd_kernels::RowFilter dateFilter() {
+        simd_kernels::RowFilter filter;
+        filter.from_day = 19000;
+        filter.to_day = 19365;
+        return filter;
+    }
+
+    void costStats(benchmark::State& state, simd_kernels::Isa isa, bool by_device) {
+        const Dataset& data = dataset(state.range(0));
+        const auto& kernels = simd_kernels::kernels(isa);
+        simd_kernels::RowFilter filter = dateFilter();
+        if (by_device) {
+            filter.device_bitmap = data.device_bitmap.data();
+            filter.device_bitmap_words = data.device_bitmap.size();
+        }
+
+        for (auto _ : state) {
+            auto stats = kernels.cost_stats(data.days.data(), data.devices.data(), data.services.data(),
+                                            data.costs.data(), data.days.size(), filter);
+            benchmark::DoNotOptimize(stats);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+        state.SetLabel(kernels.name);
+    }
+
+    void selectRows(benchmark::State& state, simd_kernels::Isa isa) {
+        const Dataset& data = dataset(state.range(0));
+        const auto& kernels = simd_kernels::kernels(isa);
+        simd_kernels::RowFilter filter = dateFilter();
+        std::vector<uint32_t> positions(data.days.size());
+
+        for (auto _ : state) {
+            size_t selected = kernels.select_rows(data.days.data(), data.devices.data(), data.services.data(),
+                                                  data.days.size(), filter, 0, positions.data());
+            benchmark::DoNotOptimize(selected);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+        state.SetLabel(kernels.name);
+    }
+
+    void countOverdue(benchmark::State& state, simd_kernels::Isa isa) {
+        const Dataset& data = dataset(state.range(0));
+        const auto& kernels = simd_kernels::kernels(isa);
+
+        for (auto _ : state) {
+            uint64_t count = kernels.count_before(data.due_days.data(), data.due_days.size(), 20000,
+                                                  std::numeric_limits<int32_t>::min());
+            benchmark::DoNotOptimize(count);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+        state.SetLabel(kernels.name);
+    }
+
+}
+
+using simd_kernels::Isa;
+
+BENCHMARK_CAPTURE(costStats, scalar_by_date, Isa::Scalar, false)->Range(1 << 12, 1 << 22);
+BENCHMARK_CAPTURE(costStats, sse42_by_date, Isa::Sse42, false)->Range(1 << 12, 1 << 22);
+BENCHMARK_CAPTURE(costStats, avx2_by_date, Isa::Avx2, false)->Range(1 << 12, 1 << 22);
+
+BENCHMARK_CAPTURE(costStats, scalar_by_device, Isa::Scalar, true)->Range(1 << 12, 1 << 22);
+BENCHMARK_CAPTURE(costStats, sse42_by_device, Isa::Sse42, true)->Range(1 << 12, 1 << 22);
+BENCHMARK_CAPTURE(costStats, avx2_by_device, Isa::Avx2, true)->Range(1 << 12, 1 << 22);
+
+BENCHMARK_CAPTURE(selectRows, scalar, Isa::Scalar)->Range(1 << 12, 1 << 22);
+BENCHMARK_CAPTURE(selectRows, sse42, Isa::Sse42)->Range(1 << 12, 1 << 22);
+BENCHMARK_CAPTURE(selectRows, avx2, Isa::Avx2)->Range(1 << 12, 1 << 22);
+
+BENCHMARK_CAPTURE(countOverdue, scalar, Isa::Scalar)->Range(1 << 12, 1 << 22);
+BENCHMARK_CAPTURE(countOverdue, sse42, Isa::Sse42)->Range(1 << 12, 1 << 22);
+BENCHMARK_CAPTURE(countOverdue, avx2, Isa::Avx2)->Range(1 << 12, 1 << 22);
+
+BENCHMARK_MAIN();
@@ -1,6 +1,9 @@
 DROP TABLE Devices CASCADE;
 DROP TABLE Service_Types CASCADE;
 DROP TABLE Service_History CASCADE;
+DROP TABLE Device_Stats CASCADE;
+DROP TABLE Users CASCADE;
+DROP TABLE schema_migrations;
 
 -- Таблица 1: Устройства (5 атрибутов - оригинал + 1)
 CREATE TABLE Devices (
@@ -30,6 +33,20 @@ CREATE TABLE Service_History (
     next_due_date DATE
 );
 
+-- Таблица 4: Пользователи. password_hash — PBKDF2-HMAC-SHA256 в формате
+-- pbkdf2_sha256$<итерации>$<соль>$<хеш> (base64url), см. src/auth.h
+CREATE TABLE Users (
+    user_id SERIAL PRIMARY KEY,
+    username VARCHAR(50) NOT NULL UNIQUE,
+    password_hash VARCHAR(200) NOT NULL,
+    role VARCHAR(20) NOT NULL DEFAULT 'user'
+);
+
 -- Простой индекс для поиска просроченного обслуживания
 CREATE INDEX idx_due_dates ON Service_History(next_due_date) 
-WHERE next_due_date IS NOT NULL;
\ No newline at end of file
+WHERE next_due_date IS NOT NULL;
+
+-- Остальная схема (индексы списков и поиска, Device_Stats с триггерами, лента изменений
+-- service_history_changes) — миграции src/migrations.cpp, их применяет сервер при старте.
+-- Таблица Users создаётся здесь для демонстрационных пользователей; миграция 3 добавляет
+-- её в базы, созданные без неё
@@ -1,9 +1,12 @@
 -- Инициализация базы данных для Service Management System
 
 -- Удаляем существующие таблицы (если есть)
+DROP TABLE IF EXISTS Device_Stats CASCADE;
 DROP TABLE IF EXISTS Service_History CASCADE;
 DROP TABLE IF EXISTS Service_Types CASCADE;
 DROP TABLE IF EXISTS Devices CASCADE;
+DROP TABLE IF EXISTS Users CASCADE;
+DROP TABLE IF EXISTS schema_migrations;
 
 -- Таблица 1: Устройства
 CREATE TABLE Devices (
@@ -33,10 +36,24 @@ CREATE TABLE Service_History (
     next_due_date DATE
 );
 
+-- Таблица 4: Пользователи. password_hash — PBKDF2-HMAC-SHA256 в формате
+-- pbkdf2_sha256$<итерации>$<соль>$<хеш> (base64url), см. src/auth.h
+CREATE TABLE Users (
+    user_id SERIAL PRIMARY KEY,
+    username VARCHAR(50) NOT NULL UNIQUE,
+    password_hash VARCHAR(200) NOT NULL,
+    role VARCHAR(20) NOT NULL DEFAULT 'user'
+);
+
 -- Индекс для поиска просроченного обслуживания
 CREATE INDEX idx_due_dates ON Service_History(next_due_date) 
 WHERE next_due_date IS NOT NULL;
 
+-- Остальная схема (индексы списков и поиска, Device_Stats с триггерами, лента изменений
+-- service_history_changes) — миграции src/migrations.cpp, их применяет сервер при старте.
+-- Таблица Users создаётся здесь для демонстрационных пользователей; миграция 3 добавляет
+-- её в базы, созданные без неё
+
 -- Вставляем тестовые данные
 INSERT INTO Devices (name, model, purchase_date, status) VALUES
     ('Printer HP LaserJet', 'HP LaserJet Pro', '2023-01-15', 'active'),
@@ -60,6 +77,11 @@ INSERT INTO Service_History (device_id, service_id, service_date, cost, notes, n
     (4, 5, '2023-08-28', 30.00, 'Проверка системы', '2023-11-28'),
     (5, 2, '2023-05-05', 100.00, 'Замена батарей', '2024-05-05');
 
+-- Пользователи по умолчанию: admin / admin123, user / user123
+INSERT INTO Users (username, password_hash, role) VALUES
+    ('admin', 'pbkdf2_sha256$310000$QTIVEmZTTr0k2MbKZ4AaZw$yTkMTcvecsV3rJBp7t9EhG3a6WJ-DxAw7tmV82NfBW4', 'admin'),
+    ('user', 'pbkdf2_sha256$310000$huai4EgeVpKYhDmSB_A8KQ$O49lk9ZufE4MQbdHv2idsne7rQQfA_S5A8YwDRU3HSs', 'user');
+
 -- Проверка
 SELECT 'Devices count: ' || COUNT(*) FROM Devices;
 SELECT 'Service_Types count: ' || COUNT(*) FROM Service_Types;
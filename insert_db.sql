@@ -49,4 +49,9 @@ INSERT INTO Service_History (device_id, service_id, service_date, cost, notes, n
 (1, 11, '2023-12-05', 500.00, 'Резервное копирование важных документов', '2024-01-05'),
 (2, 12, '2023-12-10', 1500.00, 'Оптимизация Windows, очистка реестра', '2024-06-10'),
 (5, 1, '2023-12-12', 1200.00, 'Профилактическая чистка', '2024-06-12'),
-(7, 3, '2023-12-15', 900.00, 'Диагностика проблем с печатью', '2024-03-15');
\ No newline at end of file
+(7, 3, '2023-12-15', 900.00, 'Диагностика проблем с печатью', '2024-03-15');
+
+-- Пользователи по умолчанию: admin / admin123, user / user123
+INSERT INTO Users (username, password_hash, role) VALUES
+    ('admin', 'pbkdf2_sha256$310000$QTIVEmZTTr0k2MbKZ4AaZw$yTkMTcvecsV3rJBp7t9EhG3a6WJ-DxAw7tmV82NfBW4', 'admin'),
+    ('user', 'pbkdf2_sha256$310000$huai4EgeVpKYhDmSB_A8KQ$O49lk9ZufE4MQbdHv2idsne7rQQfA_S5A8YwDRU3HSs', 'user');
@@ -0,0 +1,363 @@
+#include "analytics.h"
+#include <pqxx/pqxx>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+
+using json = nlohmann::json;
+
+namespace {
+    const char* CHANGES_CHANNEL = "service_history_changes";
+
+    // Размер блока при фильтрации: индексы отобранных строк помещаются в кэш L1
+    const size_t BLOCK_SIZE = 1024;
+
+    // Выше этого числа ключей плотные аккумуляторы заменяются хеш-таблицей
+    const int64_t MAX_DENSE_KEYS = 1 << 22;
+
+    const char* SNAPSHOT_QUERY =
+        "SELECT record_id, device_id, service_id, "
+        "service_date - DATE '1970-01-01', "
+        "ROUND(cost * 100)::BIGINT, "
+        "next_due_date - DATE '1970-01-01' "
+        "FROM Service_History";
+
+    class ChangeReceiver : public pqxx::notification_receiver {
+    private:
+        AnalyticsStore& store;
+
+    public:
+        ChangeReceiver(pqxx::connection& conn, AnalyticsStore& store)
+            : pqxx::notification_receiver(conn, CHANGES_CHANNEL), store(store) {}
+
+        void operator()(const std::string& payload, int) override {
+            store.applyChange(payload);
+        }
+    };
+
+    int32_t intOr(const json& value, int32_t fallback) {
+        return value.is_null() ? fallback : value.get<int32_t>();
+    }
+
+    // Битовые карты множеств идентификаторов фильтра для векторных ядер
+    struct FilterBitmaps {
+        std::vector<uint32_t> devices;
+        std::vector<uint32_t> services;
+        simd_kernels::RowFilter filter;
+
+        static void fill(std::vector<uint32_t>& bitmap, const std::vector<int32_t>& ids) {
+            for (int32_t id : ids) {
+                if (id < 0) {
+                    continue;
+                }
+                size_t word = static_cast<size_t>(id) >> 5;
+                if (word >= bitmap.size()) {
+                    bitmap.resize(word + 1, 0);
+                }
+                bitmap[word] |= 1u << (id & 31);
+            }
+        }
+
+        explicit FilterBitmaps(const AnalyticsStore::Filter& source) {
+            filter.from_day = source.from_day;
+            filter.to_day = source.to_day;
+            if (!source.device_ids.empty()) {
+                fill(devices, source.device_ids);
+                // Пустая карта (только отрицательные id) — ни одна строка не проходит
+                devices.resize(std::max<size_t>(devices.size(), 1), 0);
+                filter.device_bitmap = devices.data();
+                filter.device_bitmap_words = devices.size();
+            }
+            if (!source.service_ids.empty()) {
+                fill(services, source.service_ids);
+                services.resize(std::max<size_t>(services.size(), 1), 0);
+                filter.service_bitmap = services.data();
+                filter.service_bitmap_words = services.size();
+            }
+        }
+    };
+
+    struct Accumulator {
+        uint64_t count = 0;
+        int64_t total = 0;
+        int64_t min = std::numeric_limits<int64_t>::max();
+        int64_t max = std::numeric_limits<int64_t>::min();
+
+        void add(int64_t cost) {
+            ++count;
+            total += cost;
+            min = std::min(min, cost);
+            max = std::max(max, cost);
+        }
+    };
+}
+
+void AnalyticsStore::Columns::upsert(int32_t record_id, int32_t device_id, int32_t service_id,
+                                     int32_t service_day, int64_t cost_cents, int32_t next_due_day) {
+    int32_t month = monthOfDay(service_day);
+
+    auto it = positions.find(record_id);
+    if (it != positions.end()) {
+        size_t pos = it->second;
+        device_ids[pos] = device_id;
+        service_ids[pos] = service_id;
+        service_days[pos] = service_day;
+        months[pos] = month;
+        next_due_days[pos] = next_due_day;
+        costs[pos] = cost_cents;
+    } else {
+        positions.emplace(record_id, record_ids.size());
+        record_ids.push_back(record_id);
+        device_ids.push_back(device_id);
+        service_ids.push_back(service_id);
+        service_days.push_back(service_day);
+        months.push_back(month);
+        next_due_days.push_back(next_due_day);
+        costs.push_back(cost_cents);
+    }
+
+    max_device_id = std::max(max_device_id, device_id);
+    max_service_id = std::max(max_service_id, service_id);
+    min_month = std::min(min_month, month);
+    max_month = std::max(max_month, month);
+}
+
+void AnalyticsStore::Columns::remove(int32_t record_id) {
+    auto it = positions.find(record_id);
+    if (it == positions.end()) {
+        return;
+    }
+
+    // Удаление перестановкой последней строки на место удаляемой
+    size_t pos = it->second;
+    size_t last = record_ids.size() - 1;
+    positions.erase(it);
+    if (pos != last) {
+        record_ids[pos] = record_ids[last];
+        device_ids[pos] = device_ids[last];
+        service_ids[pos] = service_ids[last];
+        service_days[pos] = service_days[last];
+        months[pos] = months[last];
+        next_due_days[pos] = next_due_days[last];
+        costs[pos] = costs[last];
+        positions[record_ids[pos]] = pos;
+    }
+
+    record_ids.pop_back();
+    device_ids.pop_back();
+    service_ids.pop_back();
+    service_days.pop_back();
+    months.pop_back();
+    next_due_days.pop_back();
+    costs.pop_back();
+}
+
+AnalyticsStore::AnalyticsStore(std::string conn_str) : conn_str(std::move(conn_str)) {}
+
+AnalyticsStore::~AnalyticsStore() {
+    stop();
+}
+
+void AnalyticsStore::start() {
+    if (running.exchange(true)) {
+        return;
+    }
+    listener = std::thread([this] { listenLoop(); });
+}
+
+void AnalyticsStore::stop() {
+    running = false;
+    if (listener.joinable()) {
+        listener.join();
+    }
+}
+
+size_t AnalyticsStore::rowCount() const {
+    std::shared_lock<std::shared_mutex> lock(columns_mutex);
+    return columns.record_ids.size();
+}
+
+void AnalyticsStore::listenLoop() {
+    while (running) {
+        try {
+            pqxx::connection conn(conn_str);
+
+            // LISTEN до загрузки снимка: изменения, закоммиченные во время загрузки,
+            // придут уведомлениями и применятся повторно (upsert/delete идемпотентны)
+            ChangeReceiver receiver(conn, *this);
+            reload(conn);
+
+            while (running) {
+                if (reload_requested.exchange(false)) {
+                    reload(conn);
+                }
+                conn.await_notification(1, 0);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Analytics listener error: " << e.what() << std::endl;
+
+            // Пауза перед переподключением с проверкой остановки
+            for (int i = 0; i < 50 && running; ++i) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+        }
+    }
+}
+
+void AnalyticsStore::reload(pqxx::connection& conn) {
+    Columns fresh;
+
+    pqxx::read_transaction txn(conn);
+    for (auto [record_id, device_id, service_id, service_day, cost, next_due] :
+         txn.stream<int32_t, std::optional<int32_t>, std::optional<int32_t>, int32_t,
+                    std::optional<int64_t>, std::optional<int32_t>>(SNAPSHOT_QUERY)) {
+        fresh.upsert(record_id, device_id.value_or(-1), service_id.value_or(-1),
+                     service_day, cost.value_or(0), next_due.value_or(NO_DATE));
+    }
+    txn.commit();
+
+    {
+        std::unique_lock<std::shared_mutex> lock(columns_mutex);
+        columns = std::move(fresh);
+    }
+    loaded = true;
+    std::cerr << "Analytics snapshot loaded: " << rowCount() << " rows" << std::endl;
+}
+
+void AnalyticsStore::applyChange(const std::string& payload) {
+    try {
+        json change = json::parse(payload);
+        std::string op = change.value("op", "");
+
+        if (op == "reload") {
+            reload_requested = true;
+            return;
+        }
+
+        std::unique_lock<std::shared_mutex> lock(columns_mutex);
+        if (op == "upsert") {
+            // [record_id, device_id, service_id, service_day, cost_cents, next_due_day]
+            for (const auto& row : change.at("rows")) {
+                columns.upsert(row.at(0).get<int32_t>(), intOr(row.at(1), -1), intOr(row.at(2), -1),
+                               row.at(3).get<int32_t>(),
+                               row.at(4).is_null() ? 0 : row.at(4).get<int64_t>(),
+                               intOr(row.at(5), NO_DATE));
+            }
+        } else if (op == "delete") {
+            for (const auto& id : change.at("ids")) {
+                columns.remove(id.get<int32_t>());
+            }
+        }
+    } catch (const std::exception& e) {
+        // Нераспознанное сообщение: безопаснее перечитать снимок целиком
+        std::cerr << "Analytics change error: " << e.what() << std::endl;
+        reload_requested = true;
+    }
+}
+
+std::vector<AnalyticsStore::Group> AnalyticsStore::aggregate(GroupBy group_by, const Filter& filter) const {
+    std::shared_lock<std::shared_mutex> lock(columns_mutex);
+
+    const std::vector<int32_t>* keys = &columns.device_ids;
+    int32_t key_base = 0;
+    int64_t key_count = static_cast<int64_t>(columns.max_device_id) + 1;
+    if (group_by == GroupBy::ServiceType) {
+        keys = &columns.service_ids;
+        key_count = static_cast<int64_t>(columns.max_service_id) + 1;
+    } else if (group_by == GroupBy::Month) {
+        keys = &columns.months;
+        key_base = columns.min_month;
+        key_count = static_cast<int64_t>(columns.max_month) - columns.min_month + 1;
+    }
+
+    std::vector<Group> groups;
+    size_t rows = columns.record_ids.size();
+    if (rows == 0 || key_count <= 0) {
+        return groups;
+    }
+
+    const int32_t* days = columns.service_days.data();
+    const int32_t* devices = columns.device_ids.data();
+    const int32_t* services = columns.service_ids.data();
+    const int32_t* key_data = keys->data();
+    const int64_t* costs = columns.costs.data();
+
+    // Плотные аккумуляторы по ключу (идентификаторы SERIAL компактны),
+    // для разреженных ключей — хеш-таблица
+    bool dense = key_count <= MAX_DENSE_KEYS;
+    std::vector<Accumulator> dense_acc(dense ? key_count : 0);
+    std::unordered_map<int32_t, Accumulator> sparse_acc;
+
+    // Векторное ядро формирует позиции отобранных строк блока,
+    // затем группировка проходит только по ним
+    FilterBitmaps bitmaps(filter);
+    const auto& kernels = simd_kernels::best();
+    std::vector<uint32_t> selection(BLOCK_SIZE);
+    for (size_t block = 0; block < rows; block += BLOCK_SIZE) {
+        size_t count = std::min(rows, block + BLOCK_SIZE) - block;
+        size_t selected = kernels.select_rows(days + block, devices + block, services + block, count,
+                                              bitmaps.filter, static_cast<uint32_t>(block), selection.data());
+
+        for (size_t j = 0; j < selected; ++j) {
+            uint32_t i = selection[j];
+            if (key_data[i] < key_base) {
+                continue;
+            }
+            if (dense) {
+                dense_acc[key_data[i] - key_base].add(costs[i]);
+            } else {
+                sparse_acc[key_data[i]].add(costs[i]);
+            }
+        }
+    }
+
+    if (dense) {
+        for (int64_t slot = 0; slot < key_count; ++slot) {
+            const Accumulator& acc = dense_acc[slot];
+            if (acc.count > 0) {
+                groups.push_back({static_cast<int32_t>(slot + key_base), acc.count, acc.total, acc.min, acc.max});
+            }
+        }
+    } else {
+        for (const auto& [key, acc] : sparse_acc) {
+            groups.push_back({key, acc.count, acc.total, acc.min, acc.max});
+        }
+        std::sort(groups.begin(), groups.end(), [](const Group& a, const Group& b) { return a.key < b.key; });
+    }
+    return groups;
+}
+
+simd_kernels::CostStats AnalyticsStore::totals(const Filter& filter) const {
+    std::shared_lock<std::shared_mutex> lock(columns_mutex);
+
+    FilterBitmaps bitmaps(filter);
+    return simd_kernels::best().cost_stats(columns.service_days.data(), columns.device_ids.data(),
+                                           columns.service_ids.data(), columns.costs.data(),
+                                           columns.record_ids.size(), bitmaps.filter);
+}
+
+uint64_t AnalyticsStore::overdueCount(int32_t today) const {
+    std::shared_lock<std::shared_mutex> lock(columns_mutex);
+
+    return simd_kernels::best().count_before(columns.next_due_days.data(), columns.next_due_days.size(),
+                                             today, NO_DATE);
+}
+
+int32_t AnalyticsStore::monthOfDay(int32_t day) {
+    auto ymd = Date::fromDays(day).ymd();
+    return (static_cast<int>(ymd.year()) - 1970) * 12 + static_cast<int>(static_cast<unsigned>(ymd.month())) - 1;
+}
+
+std::string AnalyticsStore::formatMonth(int32_t month) {
+    int32_t months_from_year0 = month + 1970 * 12;
+    int year = months_from_year0 / 12;
+    int mon = months_from_year0 % 12 + 1;
+
+    std::string result = std::to_string(year) + "-";
+    if (mon < 10) {
+        result += "0";
+    }
+    return result + std::to_string(mon);
+}
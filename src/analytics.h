@@ -0,0 +1,110 @@
+#pragma once
+#include "date.h"
+#include "simd_kernels.h"
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace pqxx {
+class connection;
+}
+
+// Колоночная копия Service_History в памяти сервера для отчётов (/api/analytics).
+// Хранится как набор массивов (struct-of-arrays): даты — дни от 1970-01-01 (int32),
+// стоимость — копейки (int64). Синхронизация — через LISTEN service_history_changes
+// (триггер service_history_notify) на отдельном соединении и отдельном потоке.
+class AnalyticsStore {
+public:
+    // Значение даты для NULL (next_due_date не задана)
+    static constexpr int32_t NO_DATE = Date::NULL_DAYS;
+
+    enum class GroupBy { Device, ServiceType, Month };
+
+    // Фильтр агрегации; границы дат включительно, пустое множество — без фильтра по идентификатору
+    struct Filter {
+        int32_t from_day = std::numeric_limits<int32_t>::min();
+        int32_t to_day = std::numeric_limits<int32_t>::max();
+        std::vector<int32_t> device_ids;
+        std::vector<int32_t> service_ids;
+    };
+
+    // Ключ группы: device_id, service_id или номер месяца, отсчитанный от 1970-01
+    struct Group {
+        int32_t key;
+        uint64_t count;
+        int64_t total_cents;
+        int64_t min_cents;
+        int64_t max_cents;
+    };
+
+    explicit AnalyticsStore(std::string conn_str);
+    ~AnalyticsStore();
+
+    AnalyticsStore(const AnalyticsStore&) = delete;
+    AnalyticsStore& operator=(const AnalyticsStore&) = delete;
+
+    // Запуск потока-слушателя: LISTEN, загрузка снимка, применение изменений
+    void start();
+    void stop();
+
+    // true после первой успешной загрузки снимка
+    bool ready() const { return loaded.load(); }
+    size_t rowCount() const;
+
+    std::vector<Group> aggregate(GroupBy group_by, const Filter& filter) const;
+    
+    // Итоги по всем строкам, прошедшим фильтр (без группировки)
+    simd_kernels::CostStats totals(const Filter& filter) const;
+
+    // Количество записей с next_due_date раньше today
+    uint64_t overdueCount(int32_t today) const;
+
+    // Применение сообщения ленты изменений (JSON payload триггера)
+    void applyChange(const std::string& payload);
+
+    // Номер месяца даты (дни от 1970-01-01) и его вывод в формате YYYY-MM
+    static int32_t monthOfDay(int32_t day);
+    static std::string formatMonth(int32_t month);
+
+private:
+    // Столбцы; позиция записи одинакова во всех массивах
+    struct Columns {
+        std::vector<int32_t> record_ids;
+        std::vector<int32_t> device_ids;
+        std::vector<int32_t> service_ids;
+        std::vector<int32_t> service_days;
+        std::vector<int32_t> months;
+        std::vector<int32_t> next_due_days;
+        std::vector<int64_t> costs;
+
+        // record_id -> позиция в столбцах
+        std::unordered_map<int32_t, size_t> positions;
+
+        // Границы ключей для плотных массивов-аккумуляторов группировки
+        int32_t max_device_id = -1;
+        int32_t max_service_id = -1;
+        int32_t min_month = std::numeric_limits<int32_t>::max();
+        int32_t max_month = std::numeric_limits<int32_t>::min();
+
+        void upsert(int32_t record_id, int32_t device_id, int32_t service_id,
+                    int32_t service_day, int64_t cost_cents, int32_t next_due_day);
+        void remove(int32_t record_id);
+    };
+
+    std::string conn_str;
+    Columns columns;
+    mutable std::shared_mutex columns_mutex;
+
+    std::thread listener;
+    std::atomic<bool> running{false};
+    std::atomic<bool> loaded{false};
+    std::atomic<bool> reload_requested{false};
+
+    void listenLoop();
+    void reload(pqxx::connection& conn);
+};
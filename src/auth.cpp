@@ -0,0 +1,250 @@
+#include "auth.h"
+#include <nlohmann/json.hpp>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+#include <stdexcept>
+#include <vector>
+
+namespace auth {
+
+namespace {
+    const char* const HASH_SCHEME = "pbkdf2_sha256";
+    const size_t SALT_SIZE = 16;
+    const size_t HASH_SIZE = 32;
+
+    const char BASE64URL[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+    // base64url без дополнения '='
+    std::string base64urlEncode(const unsigned char* data, size_t size) {
+        std::string out;
+        out.reserve((size * 4 + 2) / 3);
+        size_t i = 0;
+        for (; i + 2 < size; i += 3) {
+            uint32_t chunk = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+            out += BASE64URL[(chunk >> 18) & 0x3F];
+            out += BASE64URL[(chunk >> 12) & 0x3F];
+            out += BASE64URL[(chunk >> 6) & 0x3F];
+            out += BASE64URL[chunk & 0x3F];
+        }
+        if (i + 1 == size) {
+            uint32_t chunk = data[i] << 16;
+            out += BASE64URL[(chunk >> 18) & 0x3F];
+            out += BASE64URL[(chunk >> 12) & 0x3F];
+        } else if (i + 2 == size) {
+            uint32_t chunk = (data[i] << 16) | (data[i + 1] << 8);
+            out += BASE64URL[(chunk >> 18) & 0x3F];
+            out += BASE64URL[(chunk >> 12) & 0x3F];
+            out += BASE64URL[(chunk >> 6) & 0x3F];
+        }
+        return out;
+    }
+
+    std::string base64urlEncode(std::string_view data) {
+        return base64urlEncode(reinterpret_cast<const unsigned char*>(data.data()), data.size());
+    }
+
+    int base64urlValue(char c) {
+        if (c >= 'A' && c <= 'Z') return c - 'A';
+        if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+        if (c >= '0' && c <= '9') return c - '0' + 52;
+        if (c == '-') return 62;
+        if (c == '_') return 63;
+        return -1;
+    }
+
+    std::optional<std::string> base64urlDecode(std::string_view text) {
+        if (text.size() % 4 == 1) {
+            return std::nullopt;
+        }
+        std::string out;
+        out.reserve(text.size() * 3 / 4);
+        uint32_t buffer = 0;
+        int bits = 0;
+        for (char c : text) {
+            int value = base64urlValue(c);
+            if (value < 0) {
+                return std::nullopt;
+            }
+            buffer = (buffer << 6) | static_cast<uint32_t>(value);
+            bits += 6;
+            if (bits >= 8) {
+                bits -= 8;
+                out += static_cast<char>((buffer >> bits) & 0xFF);
+            }
+        }
+        return out;
+    }
+
+    std::vector<unsigned char> pbkdf2(const std::string& password, const std::string& salt, int iterations) {
+        std::vector<unsigned char> hash(HASH_SIZE);
+        if (PKCS5_PBKDF2_HMAC(password.data(), static_cast<int>(password.size()),
+                              reinterpret_cast<const unsigned char*>(salt.data()), static_cast<int>(salt.size()),
+                              iterations, EVP_sha256(), static_cast<int>(hash.size()), hash.data()) != 1) {
+            throw std::runtime_error("PBKDF2 failed");
+        }
+        return hash;
+    }
+
+    // Разбор "pbkdf2_sha256$итерации$соль$хеш"
+    struct EncodedHash {
+        int iterations = 0;
+        std::string salt;
+        std::string hash;
+    };
+
+    std::optional<EncodedHash> parseHash(const std::string& encoded) {
+        size_t first = encoded.find('$');
+        size_t second = first == std::string::npos ? first : encoded.find('$', first + 1);
+        size_t third = second == std::string::npos ? second : encoded.find('$', second + 1);
+        if (third == std::string::npos || encoded.compare(0, first, HASH_SCHEME) != 0) {
+            return std::nullopt;
+        }
+
+        EncodedHash result;
+        try {
+            result.iterations = std::stoi(encoded.substr(first + 1, second - first - 1));
+        } catch (const std::exception&) {
+            return std::nullopt;
+        }
+        auto salt = base64urlDecode(std::string_view(encoded).substr(second + 1, third - second - 1));
+        auto hash = base64urlDecode(std::string_view(encoded).substr(third + 1));
+        if (result.iterations <= 0 || !salt || !hash || hash->size() != HASH_SIZE) {
+            return std::nullopt;
+        }
+        result.salt = std::move(*salt);
+        result.hash = std::move(*hash);
+        return result;
+    }
+}
+
+int64_t unixNow() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+TokenSigner::TokenSigner(std::string secret) : secret(std::move(secret)) {
+    if (this->secret.empty()) {
+        throw std::invalid_argument("Token secret must not be empty");
+    }
+}
+
+std::string TokenSigner::sign(std::string_view payload) const {
+    unsigned char mac[EVP_MAX_MD_SIZE];
+    unsigned int mac_size = 0;
+    HMAC(EVP_sha256(), secret.data(), static_cast<int>(secret.size()),
+         reinterpret_cast<const unsigned char*>(payload.data()), payload.size(), mac, &mac_size);
+    return base64urlEncode(mac, mac_size);
+}
+
+std::string TokenSigner::issue(const std::string& username, const std::string& role,
+                               std::chrono::seconds ttl) const {
+    nlohmann::json claims;
+    claims["sub"] = username;
+    claims["role"] = role;
+    claims["exp"] = unixNow() + ttl.count();
+
+    std::string payload = base64urlEncode(claims.dump());
+    return payload + "." + sign(payload);
+}
+
+std::optional<Claims> TokenSigner::verify(std::string_view token, int64_t now) const {
+    size_t dot = token.find('.');
+    if (dot == std::string_view::npos) {
+        return std::nullopt;
+    }
+    std::string_view payload = token.substr(0, dot);
+    std::string_view signature = token.substr(dot + 1);
+
+    std::string expected = sign(payload);
+    if (signature.size() != expected.size() ||
+        CRYPTO_memcmp(signature.data(), expected.data(), expected.size()) != 0) {
+        return std::nullopt;
+    }
+
+    auto decoded = base64urlDecode(payload);
+    if (!decoded) {
+        return std::nullopt;
+    }
+    try {
+        auto claims_json = nlohmann::json::parse(*decoded);
+        Claims claims;
+        claims.username = claims_json.at("sub").get<std::string>();
+        claims.role = claims_json.at("role").get<std::string>();
+        claims.expires_at = claims_json.at("exp").get<int64_t>();
+        if (claims.expires_at <= now) {
+            return std::nullopt;
+        }
+        return claims;
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+std::optional<Claims> TokenCache::find(const std::string& token, int64_t now) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(token);
+    if (it == entries.end()) {
+        return std::nullopt;
+    }
+    if (it->second.expires_at <= now) {
+        entries.erase(it);
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+void TokenCache::insert(const std::string& token, const Claims& claims, int64_t now) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (entries.size() >= capacity) {
+        for (auto it = entries.begin(); it != entries.end();) {
+            it = it->second.expires_at <= now ? entries.erase(it) : std::next(it);
+        }
+        // Все записи действительны — освобождается произвольная
+        if (entries.size() >= capacity) {
+            entries.erase(entries.begin());
+        }
+    }
+    entries[token] = claims;
+}
+
+void TokenCache::erase(const std::string& token) {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.erase(token);
+}
+
+std::string hashPassword(const std::string& password, int iterations) {
+    unsigned char salt[SALT_SIZE];
+    if (RAND_bytes(salt, sizeof(salt)) != 1) {
+        throw std::runtime_error("RAND_bytes failed");
+    }
+    std::string salt_bytes(reinterpret_cast<const char*>(salt), sizeof(salt));
+    auto hash = pbkdf2(password, salt_bytes, iterations);
+    return std::string(HASH_SCHEME) + "$" + std::to_string(iterations) + "$" +
+           base64urlEncode(salt, sizeof(salt)) + "$" + base64urlEncode(hash.data(), hash.size());
+}
+
+bool verifyPassword(const std::string& password, const std::string& encoded) {
+    auto parsed = parseHash(encoded);
+    if (!parsed) {
+        return false;
+    }
+    auto hash = pbkdf2(password, parsed->salt, parsed->iterations);
+    return CRYPTO_memcmp(hash.data(), parsed->hash.data(), HASH_SIZE) == 0;
+}
+
+int hashIterations(const std::string& encoded) {
+    auto parsed = parseHash(encoded);
+    return parsed ? parsed->iterations : 0;
+}
+
+std::string randomSecret(size_t bytes) {
+    std::vector<unsigned char> buffer(bytes);
+    if (RAND_bytes(buffer.data(), static_cast<int>(buffer.size())) != 1) {
+        throw std::runtime_error("RAND_bytes failed");
+    }
+    return base64urlEncode(buffer.data(), buffer.size());
+}
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Аутентификация без обращения к БД на каждый запрос:
+// подписанные токены (HMAC-SHA256) со сроком действия, кэш проверенных токенов
+// и хеши паролей PBKDF2-HMAC-SHA256 с настраиваемым числом итераций (OpenSSL).
+namespace auth {
+    struct Claims {
+        std::string username;
+        std::string role;
+        int64_t expires_at = 0;  // Unix time, секунды
+    };
+
+    int64_t unixNow();
+
+    // Токен: base64url(JSON {"sub","role","exp"}) "." base64url(HMAC-SHA256(секрет, первая часть))
+    class TokenSigner {
+    private:
+        std::string secret;
+
+        std::string sign(std::string_view payload) const;
+
+    public:
+        explicit TokenSigner(std::string secret);
+
+        std::string issue(const std::string& username, const std::string& role, std::chrono::seconds ttl) const;
+
+        // Подпись сравнивается за постоянное время; просроченный токен недействителен
+        std::optional<Claims> verify(std::string_view token, int64_t now) const;
+    };
+
+    // Кэш проверенных токенов: повторный запрос с тем же токеном обходится без HMAC
+    // и разбора JSON. При заполнении сначала вытесняются просроченные записи
+    class TokenCache {
+    private:
+        size_t capacity;
+        std::unordered_map<std::string, Claims> entries;
+        std::mutex mutex;
+
+    public:
+        explicit TokenCache(size_t capacity = 1024) : capacity(capacity) {}
+
+        std::optional<Claims> find(const std::string& token, int64_t now);
+        void insert(const std::string& token, const Claims& claims, int64_t now);
+        void erase(const std::string& token);
+    };
+
+    // Хеш пароля: "pbkdf2_sha256$<итерации>$<соль base64url>$<хеш base64url>".
+    // Число итераций хранится в хеше, поэтому его можно менять без перевыпуска старых хешей
+    std::string hashPassword(const std::string& password, int iterations);
+    bool verifyPassword(const std::string& password, const std::string& encoded);
+
+    // Число итераций из закодированного хеша; 0 — формат не распознан
+    int hashIterations(const std::string& encoded);
+
+    // Случайный секрет для подписи (base64url), если он не задан в конфигурации
+    std::string randomSecret(size_t bytes = 32);
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include "auth.h"
+#include "metrics.h"
+#include <crow.h>
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <memory>
+#include <string>
+
+// Middleware Crow: проверяет "Authorization: Bearer <токен>" без обращения к БД.
+// Изменяющие запросы к /api/ (кроме входа и выхода) без действительного токена
+// получают 401 до вызова обработчика; для остальных запросов токен необязателен,
+// но при наличии тоже проверяется и попадает в контекст.
+struct AuthMiddleware {
+    struct context {
+        bool authenticated = false;
+        auth::Claims claims;
+    };
+
+    std::shared_ptr<const auth::TokenSigner> signer;
+    auth::TokenCache cache;
+
+    void configure(std::shared_ptr<const auth::TokenSigner> token_signer) {
+        signer = std::move(token_signer);
+    }
+
+    static bool requiresAuth(const crow::request& req) {
+        if (req.method == crow::HTTPMethod::Get || req.method == crow::HTTPMethod::Head ||
+            req.method == crow::HTTPMethod::Options) {
+            return false;
+        }
+        return req.url.rfind("/api/", 0) == 0 && req.url != "/api/login" && req.url != "/api/logout";
+    }
+
+    // Токен из заголовка; пустая строка — заголовка нет или схема не Bearer
+    static std::string bearerToken(const crow::request& req) {
+        const std::string& header = req.get_header_value("Authorization");
+        const std::string prefix = "Bearer ";
+        if (header.size() <= prefix.size() || header.compare(0, prefix.size(), prefix) != 0) {
+            return "";
+        }
+        return header.substr(prefix.size());
+    }
+
+    // Сначала кэш, затем проверка подписи; результат — в метрике auth_token_verify_seconds
+    std::optional<auth::Claims> verify(const std::string& token) {
+        auto start_time = std::chrono::steady_clock::now();
+        int64_t now = auth::unixNow();
+        const char* result = "cache_hit";
+
+        auto claims = cache.find(token, now);
+        if (!claims) {
+            claims = signer ? signer->verify(token, now) : std::nullopt;
+            result = claims ? "valid" : "invalid";
+            if (claims) {
+                cache.insert(token, *claims, now);
+            }
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+        MetricsRegistry::getInstance().recordTokenVerification(result, elapsed.count());
+        return claims;
+    }
+
+    void before_handle(crow::request& req, crow::response& res, context& ctx) {
+        std::string token = bearerToken(req);
+        if (!token.empty()) {
+            if (auto claims = verify(token)) {
+                ctx.authenticated = true;
+                ctx.claims = std::move(*claims);
+            }
+        }
+
+        if (ctx.authenticated || !requiresAuth(req)) {
+            return;
+        }
+
+        MetricsRegistry::getInstance().recordAuthRejection(token.empty() ? "missing" : "invalid");
+
+        nlohmann::json response;
+        response["success"] = false;
+        response["error"] = token.empty() ? "Authentication required" : "Invalid or expired token";
+
+        res.code = 401;
+        res.set_header("Content-Type", "application/json; charset=utf-8");
+        res.set_header("Access-Control-Allow-Origin", "*");
+        res.set_header("WWW-Authenticate", "Bearer");
+        res.body = response.dump();
+        res.end();
+    }
+
+    void after_handle(crow::request&, crow::response&, context&) {}
+};
@@ -0,0 +1,47 @@
+#include "concurrency_limiter.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+ConcurrencyLimiter::ConcurrencyLimiter(Settings settings) : settings(settings) {
+    if (settings.min_limit < 1.0 || settings.max_limit < settings.min_limit ||
+        settings.backoff_ratio <= 0.0 || settings.backoff_ratio >= 1.0) {
+        throw std::invalid_argument("Invalid concurrency limiter settings");
+    }
+    current_limit = std::clamp(settings.initial_limit, settings.min_limit, settings.max_limit);
+}
+
+bool ConcurrencyLimiter::tryAcquire() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (in_flight >= static_cast<int>(std::floor(current_limit))) {
+        return false;
+    }
+    ++in_flight;
+    return true;
+}
+
+void ConcurrencyLimiter::release(Clock::time_point acquired_at, Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Лимит растёт, только если он действительно используется
+    bool saturated = in_flight * 2 >= static_cast<int>(std::floor(current_limit));
+    --in_flight;
+
+    if (now - acquired_at > settings.latency_threshold) {
+        if (acquired_at >= last_decrease) {
+            current_limit = std::max(settings.min_limit, current_limit * settings.backoff_ratio);
+            last_decrease = now;
+        }
+    } else if (saturated) {
+        current_limit = std::min(settings.max_limit, current_limit + 1.0 / current_limit);
+    }
+}
+
+double ConcurrencyLimiter::limit() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return current_limit;
+}
+
+int ConcurrencyLimiter::inFlight() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return in_flight;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <chrono>
+#include <mutex>
+
+// Адаптивный лимит одновременных запросов к БД (AIMD). Запрос сверх лимита
+// не ставится в очередь DbExecutor, а сразу получает отказ (503). Время ответа
+// каждого допущенного запроса — от допуска до завершения, включая ожидание
+// в очереди пула — управляет лимитом: медленный ответ (дольше latency_threshold)
+// уменьшает лимит в backoff_ratio раз, быстрый при занятом лимите — увеличивает
+// примерно на единицу за каждые limit завершённых запросов.
+class ConcurrencyLimiter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Settings {
+        double initial_limit = 8.0;
+        double min_limit = 1.0;
+        double max_limit = 64.0;
+        std::chrono::milliseconds latency_threshold{250};
+        double backoff_ratio = 0.9;
+    };
+
+    // Занятый слот; освобождается в деструкторе, в том числе при исключении в обработчике
+    class Permit {
+    private:
+        ConcurrencyLimiter& limiter;
+        Clock::time_point acquired_at;
+
+    public:
+        Permit(ConcurrencyLimiter& limiter, Clock::time_point acquired_at)
+            : limiter(limiter), acquired_at(acquired_at) {}
+        ~Permit() { limiter.release(acquired_at); }
+
+        Permit(const Permit&) = delete;
+        Permit& operator=(const Permit&) = delete;
+    };
+
+    explicit ConcurrencyLimiter(Settings settings);
+
+    // true — слот занят, и его нужно освободить через release (или Permit)
+    bool tryAcquire();
+
+    // Завершение запроса, допущенного в acquired_at
+    void release(Clock::time_point acquired_at, Clock::time_point now = Clock::now());
+
+    double limit() const;
+    int inFlight() const;
+
+private:
+    Settings settings;
+    mutable std::mutex mutex;
+    double current_limit;
+    int in_flight = 0;
+    // Медленные ответы запросов, допущенных до последнего снижения, лимит больше не снижают:
+    // одна волна задержек — одно снижение
+    Clock::time_point last_decrease;
+};
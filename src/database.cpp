@@ -1,108 +1,629 @@
 #include "database.h"
+#include "metrics.h"
+#include "migrations.h"
+#include "pg_binary.h"
+#include "pipeline_batcher.h"
+#include "request_deadline.h"
+#include <chrono>
 #include <iostream>
+#include <optional>
+#include <unordered_set>
 
-Database::Database(const std::string& conn_str) {
+// Колонки Service_History в порядке, ожидаемом serviceRecordFromRow
+#define SERVICE_RECORD_COLUMNS "record_id, device_id, service_id, service_date, cost, notes, next_due_date"
+
+// Выборки без ORDER BY: к ним добавляются условия фильтра и сортировка
+#define DEVICES_SELECT "SELECT device_id, name, model, purchase_date, status FROM Devices"
+
+#define DETAILED_HISTORY_SELECT \
+    "SELECT " \
+    "sh.record_id, " \
+    "d.name as device_name, " \
+    "d.model, " \
+    "st.name as service_name, " \
+    "sh.service_date, " \
+    "sh.cost, " \
+    "sh.notes, " \
+    "sh.next_due_date " \
+    "FROM Service_History sh " \
+    "JOIN Devices d ON sh.device_id = d.device_id " \
+    "JOIN Service_Types st ON sh.service_id = st.service_id"
+
+namespace {
+    const char* const DEVICES_QUERY = DEVICES_SELECT " ORDER BY device_id";
+    
+    const char* const SERVICE_TYPES_QUERY =
+        "SELECT service_id, name, recommended_interval_months, standard_cost FROM Service_Types ORDER BY service_id";
+    
+    const char* const COUNTS_QUERY =
+        "SELECT (SELECT COUNT(*) FROM Devices), "
+        "(SELECT COUNT(*) FROM Service_Types), "
+        "(SELECT COUNT(*) FROM Service_History)";
+    
+    const char* const DETAILED_HISTORY_QUERY = DETAILED_HISTORY_SELECT " ORDER BY sh.service_date DESC";
+    
+    // Ключ сортировки API -> выражение ORDER BY. Последним добавляется первичный ключ,
+    // чтобы порядок был однозначным и страницы limit/offset не пересекались
+    struct SortKey {
+        const char* key;
+        const char* column;
+    };
+    
+    const SortKey DEVICE_SORT_KEYS[] = {
+        {"id", "device_id"},
+        {"name", "name"},
+        {"model", "model"},
+        {"purchase_date", "purchase_date"},
+        {"status", "status"},
+    };
+    
+    const SortKey HISTORY_SORT_KEYS[] = {
+        {"date", "sh.service_date"},
+        {"id", "sh.record_id"},
+        {"cost", "sh.cost"},
+        {"next_due_date", "sh.next_due_date"},
+        {"device", "d.name"},
+        {"service", "st.name"},
+    };
+    
+    template<size_t N>
+    const char* findSortColumn(const SortKey (&keys)[N], const std::string& key) {
+        for (const auto& sort_key : keys) {
+            if (key == sort_key.key) {
+                return sort_key.column;
+            }
+        }
+        return nullptr;
+    }
+    
+    // Условия WHERE с параметрами $1, $2, ...: значения передаются в текстовом виде,
+    // тип выводит сервер по контексту (или по явному приведению в условии)
+    class SqlFilter {
+    private:
+        std::string where;
+        std::vector<std::string> values;
+        
+    public:
+        std::string bind(std::string value) {
+            values.push_back(std::move(value));
+            return "$" + std::to_string(values.size());
+        }
+        
+        void require(const std::string& condition) {
+            where += where.empty() ? " WHERE " : " AND ";
+            where += condition;
+        }
+        
+        const std::string& clause() const { return where; }
+        const std::vector<std::string>& params() const { return values; }
+    };
+    
+    // Шаблон ILIKE для поиска подстроки: спецсимволы LIKE экранируются
+    std::string containsPattern(const std::string& text) {
+        std::string pattern = "%";
+        for (char c : text) {
+            if (c == '%' || c == '_' || c == '\\') {
+                pattern += '\\';
+            }
+            pattern += c;
+        }
+        pattern += '%';
+        return pattern;
+    }
+    
+    std::string orderAndPage(SqlFilter& filter, const char* column, const char* primary_key,
+                             bool descending, int limit, int offset) {
+        const char* direction = descending ? " DESC" : "";
+        std::string sql = std::string(" ORDER BY ") + column + direction;
+        if (std::string(column) != primary_key) {
+            sql += std::string(", ") + primary_key + direction;
+        }
+        if (limit > 0) {
+            sql += " LIMIT " + filter.bind(std::to_string(limit));
+        }
+        if (offset > 0) {
+            sql += " OFFSET " + filter.bind(std::to_string(offset));
+        }
+        return sql;
+    }
+    
+    pqxx::params toParams(const std::vector<std::string>& values) {
+        pqxx::params params;
+        for (const auto& value : values) {
+            params.append(value);
+        }
+        return params;
+    }
+    
+    Device deviceFromRow(const pqxx::row& row) {
+        Device d;
+        d.id = row[0].as<int>();
+        d.name = row[1].as<std::string>();
+        d.model = row[2].as<std::string>("");
+        d.purchase_date = row[3].as<Date>();
+        d.status = row[4].as<std::string>("active");
+        return d;
+    }
+    
+    ServiceType serviceTypeFromRow(const pqxx::row& row) {
+        ServiceType st;
+        st.id = row[0].as<int>();
+        st.name = row[1].as<std::string>();
+        st.recommended_interval_months = row[2].as<int>(0);
+        st.standard_cost = row[3].as<Money>(Money());
+        return st;
+    }
+    
+    ServiceRecord serviceRecordFromRow(const pqxx::row& row) {
+        ServiceRecord sr;
+        sr.id = row[0].as<int>();
+        sr.device_id = row[1].as<int>();
+        sr.service_id = row[2].as<int>();
+        sr.service_date = row[3].as<Date>();
+        sr.cost = row[4].as<Money>(Money());
+        sr.notes = row[5].as<std::string>("");
+        sr.next_due_date = row[6].as<Date>();
+        return sr;
+    }
+    
+    // Строки /api/dashboard из бинарного результата; NULL — как в текстовом пути
+    json deviceToJson(const pg_binary::Result& rows, int row) {
+        json j;
+        j["id"] = rows.int4(row, 0);
+        j["name"] = std::string(rows.text(row, 1));
+        j["model"] = std::string(rows.text(row, 2));
+        j["purchase_date"] = rows.date(row, 3);
+        j["status"] = rows.isNull(row, 4) ? std::string("active") : std::string(rows.text(row, 4));
+        return j;
+    }
+    
+    json serviceTypeToJson(const pg_binary::Result& rows, int row) {
+        json j;
+        j["id"] = rows.int4(row, 0);
+        j["name"] = std::string(rows.text(row, 1));
+        j["recommended_interval_months"] = rows.isNull(row, 2) ? 0 : rows.int4(row, 2);
+        j["standard_cost"] = rows.numeric(row, 3);
+        return j;
+    }
+    
+    json detailedRecordToJson(const pg_binary::Result& rows, int row) {
+        json record;
+        record["record_id"] = rows.int4(row, 0);
+        record["device_name"] = std::string(rows.text(row, 1));
+        record["model"] = std::string(rows.text(row, 2));
+        record["service_name"] = std::string(rows.text(row, 3));
+        record["service_date"] = rows.date(row, 4);
+        record["cost"] = rows.numeric(row, 5);
+        record["notes"] = std::string(rows.text(row, 6));
+        record["next_due_date"] = rows.date(row, 7);
+        return record;
+    }
+    
+    // Оставшееся время запроса (RequestDeadline) ограничивает каждый оператор транзакции:
+    // PostgreSQL прерывает запрос сам, и соединение не занято дольше срока.
+    // Истёкший срок даёт 1 мс — запрос прерывается сразу. Вне запроса со сроком — настройка сервера
+    void limitToDeadline(pqxx::transaction_base& txn) {
+        if (auto remaining = RequestDeadline::remaining()) {
+            txn.exec0("SET LOCAL statement_timeout = " + std::to_string(remaining->count()));
+        }
+    }
+    
+    // Запрос, прерванный по statement_timeout из limitToDeadline (SQLSTATE 57014), поднимается
+    // как DeadlineExceeded: обработчик ответит 504, а не пустым результатом или ошибкой.
+    // Остальные ошибки по-прежнему обрабатывает сам метод Database
+    void rethrowIfCancelled(const std::exception& e) {
+        if (!RequestDeadline::current()) {
+            return;
+        }
+        std::string sqlstate;
+        if (const auto* sql_error = dynamic_cast<const pqxx::sql_error*>(&e)) {
+            sqlstate = sql_error->sqlstate();
+        } else if (const auto* binary_error = dynamic_cast<const pg_binary::Error*>(&e)) {
+            sqlstate = binary_error->sqlstate();
+        }
+        if (sqlstate == "57014") {
+            throw DeadlineExceeded("database");
+        }
+    }
+}
+
+namespace {
+    std::string_view viewOrEmpty(const pqxx::field& field) {
+        return field.is_null() ? std::string_view() : field.view();
+    }
+}
+
+DeviceView DeviceView::fromRow(const pqxx::row& row) {
+    DeviceView d;
+    d.id = row[0].as<int>();
+    d.name = row[1].view();
+    d.model = viewOrEmpty(row[2]);
+    d.purchase_date = row[3].as<Date>();
+    d.status = row[4].is_null() ? std::string_view("active") : row[4].view();
+    return d;
+}
+
+ServiceTypeView ServiceTypeView::fromRow(const pqxx::row& row) {
+    ServiceTypeView st;
+    st.id = row[0].as<int>();
+    st.name = row[1].view();
+    st.recommended_interval_months = row[2].as<int>(0);
+    st.standard_cost = row[3].as<Money>(Money());
+    return st;
+}
+
+ServiceRecordView ServiceRecordView::fromRow(const pqxx::row& row) {
+    ServiceRecordView sr;
+    sr.id = row[0].as<int>();
+    sr.device_id = row[1].as<int>();
+    sr.service_id = row[2].as<int>();
+    sr.service_date = row[3].as<Date>();
+    sr.cost = row[4].as<Money>(Money());
+    sr.notes = viewOrEmpty(row[5]);
+    sr.next_due_date = row[6].as<Date>();
+    return sr;
+}
+
+Database::ConnectionLease::~ConnectionLease() {
+    if (pooled) {
+        owner->release(pooled);
+    }
+}
+
+Database::Database(const std::string& conn_str, size_t pool_size) {
+    if (pool_size == 0) {
+        pool_size = 1;
+    }
+    
+    // Пакет pipeline занимает одно соединение пула на все свои сегменты
+    pipeline = std::make_unique<PipelineBatcher>(PipelineBatcher::Settings(),
+        [this](const std::vector<const pg_binary::PipelineSegment*>& segments) {
+            auto conn = acquire();
+            return pg_binary::runPipeline(conn.raw(), segments);
+        });
+    
+    connections.reserve(pool_size);
     try {
-        conn = std::make_unique<pqxx::connection>(conn_str);
-        if (conn->is_open()) {
-            std::cout << "Connected to database successfully" << std::endl;
-        } else {
-            std::cerr << "Failed to connect to database" << std::endl;
+        for (size_t i = 0; i < pool_size; ++i) {
+            pqxx::connection opened(conn_str);
+            if (!opened.is_open()) {
+                std::cerr << "Failed to connect to database" << std::endl;
+                return;
+            }
+            // pqxx открывает PGconn только через release/seize: соединение настраивается
+            // обычным конструктором, затем тот же PGconn передаётся новому pqxx::connection
+            PGconn* raw = std::move(opened).release_raw_connection();
+            auto conn = std::make_unique<pqxx::connection>(pqxx::connection::seize_raw_connection(raw));
+            connections.push_back({std::move(conn), raw});
+            idle_connections.push_back(&connections.back());
         }
+        std::cout << "Connected to database successfully (pool size: " << connections.size() << ")" << std::endl;
     } catch (const std::exception& e) {
         std::cerr << "Database connection error: " << e.what() << std::endl;
     }
 }
 
+// Подготовленные запросы регистрируются на каждом соединении пула после миграций:
+// device_details ссылается на Device_Stats, которой в старых базах нет до миграции 5
+void Database::prepareStatements(pqxx::connection& conn) {
+    // Условие next_due_date IS NOT NULL совпадает с частичным индексом idx_due_dates
+    conn.prepare("overdue_maintenance",
+        "SELECT sh.record_id, d.device_id, d.name, d.model, st.name, "
+        "sh.service_date, sh.next_due_date, (CURRENT_DATE - sh.next_due_date) AS days_overdue "
+        "FROM Service_History sh "
+        "JOIN Devices d ON sh.device_id = d.device_id "
+        "JOIN Service_Types st ON sh.service_id = st.service_id "
+        "WHERE sh.next_due_date IS NOT NULL AND sh.next_due_date < CURRENT_DATE "
+        "AND d.status = 'active' "
+        "ORDER BY sh.next_due_date");
+    
+    conn.prepare("upcoming_maintenance",
+        "SELECT sh.record_id, d.device_id, d.name, d.model, st.name, "
+        "sh.service_date, sh.next_due_date, (sh.next_due_date - CURRENT_DATE) AS days_until "
+        "FROM Service_History sh "
+        "JOIN Devices d ON sh.device_id = d.device_id "
+        "JOIN Service_Types st ON sh.service_id = st.service_id "
+        "WHERE sh.next_due_date IS NOT NULL "
+        "AND sh.next_due_date >= CURRENT_DATE AND sh.next_due_date <= CURRENT_DATE + $1::int "
+        "AND d.status = 'active' "
+        "ORDER BY sh.next_due_date");
+    
+    conn.prepare("device_details",
+        "SELECT d.device_id, d.name, d.model, d.purchase_date, d.status, "
+        "COALESCE(ds.service_count, 0), ds.total_cost, ds.last_service_date "
+        "FROM Devices d "
+        "LEFT JOIN Device_Stats ds ON ds.device_id = d.device_id "
+        "WHERE d.device_id = $1");
+    
+    // Из Service_History читаются только ключ и INCLUDE-колонки idx_history_device_covering,
+    // поэтому выборка — index-only scan по диапазону одного устройства
+    conn.prepare("device_history",
+        "SELECT sh.record_id, sh.service_id, st.name, sh.service_date, sh.cost, sh.next_due_date "
+        "FROM Service_History sh "
+        "LEFT JOIN Service_Types st ON st.service_id = sh.service_id "
+        "WHERE sh.device_id = $1 "
+        "ORDER BY sh.service_date DESC, sh.record_id DESC "
+        "LIMIT $2 OFFSET $3");
+}
+
 Database::~Database() {
-    // Удаляем вызов conn->close() - соединение закроется автоматически
-    // При уничтожении unique_ptr, деструктор pqxx::connection вызовется автоматически
+    // Батчер останавливается первым: его поток ещё может арендовать соединение
+    pipeline.reset();
+    // Соединения закроются автоматически при уничтожении unique_ptr
+}
+
+void Database::setPipelineSettings(std::chrono::microseconds window, size_t max_batch) {
+    PipelineBatcher::Settings settings;
+    settings.window = window;
+    settings.max_batch = max_batch;
+    pipeline->configure(settings);
 }
 
 bool Database::connect() {
-    return conn && conn->is_open();
+    if (connections.empty()) {
+        return false;
+    }
+    for (const auto& pooled : connections) {
+        if (!pooled.conn->is_open()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Database::ConnectionLease Database::acquire() {
+    std::unique_lock<std::mutex> lock(pool_mutex);
+    if (connections.empty()) {
+        throw std::runtime_error("Database connection pool is empty");
+    }
+    pool_cv.wait(lock, [this] { return !idle_connections.empty(); });
+    
+    PooledConnection* pooled = idle_connections.back();
+    idle_connections.pop_back();
+    return ConnectionLease(this, pooled);
+}
+
+void Database::release(PooledConnection* pooled) {
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        idle_connections.push_back(pooled);
+    }
+    pool_cv.notify_one();
+}
+
+int Database::migrate() {
+    int version = -1;
+    try {
+        auto conn = acquire();
+        version = migrations::run(*conn);
+    } catch (const std::exception& e) {
+        std::cerr << "Schema migration error: " << e.what() << std::endl;
+    }
+    
+    // Запросы готовятся и при неудачной миграции: остальные эндпоинты продолжают работать.
+    // Все соединения удерживаются разом, иначе acquire() вернёт одно и то же
+    std::vector<ConnectionLease> leases;
+    for (size_t i = 0; i < connections.size(); ++i) {
+        leases.push_back(acquire());
+    }
+    for (auto& conn : leases) {
+        try {
+            prepareStatements(*conn);
+        } catch (const std::exception& e) {
+            std::cerr << "Prepare statements error: " << e.what() << std::endl;
+        }
+    }
+    return version;
 }
 
 bool Database::testConnection() {
     try {
+        auto conn = acquire();
         pqxx::work txn(*conn);
+        limitToDeadline(txn);
         txn.exec("SELECT 1");
         return true;
     } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
         std::cerr << "Test connection failed: " << e.what() << std::endl;
         return false;
     }
 }
 
-std::vector<Device> Database::getAllDevices() {
-    std::vector<Device> devices;
+bool Database::isDeviceSortKey(const std::string& key) {
+    return findSortColumn(DEVICE_SORT_KEYS, key) != nullptr;
+}
+
+bool Database::isHistorySortKey(const std::string& key) {
+    return findSortColumn(HISTORY_SORT_KEYS, key) != nullptr;
+}
+
+// pqxx::result разделяемый (счётчик ссылок): после commit и возврата соединения
+// в пул буфер строк остаётся жив, пока на него ссылается RowViews
+RowViews<DeviceView> Database::getDeviceViews(const DeviceQuery& query) {
+    SqlFilter filter;
+    if (!query.ids.empty()) {
+        filter.require("device_id = ANY(" + filter.bind(pqxx::to_string(query.ids)) + "::int[])");
+    }
+    if (!query.status.empty()) {
+        filter.require("status = " + filter.bind(query.status));
+    }
+    if (!query.search.empty()) {
+        std::string pattern = filter.bind(containsPattern(query.search));
+        filter.require("(name ILIKE " + pattern + " OR model ILIKE " + pattern + ")");
+    }
+    
+    const char* column = findSortColumn(DEVICE_SORT_KEYS, query.sort);
+    std::string sql = DEVICES_SELECT + filter.clause() +
+                      orderAndPage(filter, column ? column : "device_id", "device_id",
+                                   query.descending, query.limit, query.offset);
+    
+    try {
+        auto conn = acquire();
+        pqxx::work txn(*conn);
+        limitToDeadline(txn);
+        pqxx::result result = txn.exec_params(sql, toParams(filter.params()));
+        txn.commit();
+        return RowViews<DeviceView>(std::move(result));
+    } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
+        std::cerr << "Error getting devices: " << e.what() << std::endl;
+    }
+    return RowViews<DeviceView>();
+}
+
+RowViews<ServiceTypeView> Database::getServiceTypeViews() {
     try {
+        auto conn = acquire();
         pqxx::work txn(*conn);
+        limitToDeadline(txn);
+        pqxx::result result = txn.exec(SERVICE_TYPES_QUERY);
+        txn.commit();
+        return RowViews<ServiceTypeView>(std::move(result));
+    } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
+        std::cerr << "Error getting service types: " << e.what() << std::endl;
+    }
+    return RowViews<ServiceTypeView>();
+}
+
+RowViews<ServiceRecordView> Database::getServiceRecordViews() {
+    try {
+        auto conn = acquire();
+        pqxx::work txn(*conn);
+        limitToDeadline(txn);
         pqxx::result result = txn.exec(
-            "SELECT device_id, name, model, purchase_date, status FROM Devices ORDER BY device_id"
+            "SELECT " SERVICE_RECORD_COLUMNS " FROM Service_History ORDER BY service_date DESC"
         );
+        txn.commit();
+        return RowViews<ServiceRecordView>(std::move(result));
+    } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
+        std::cerr << "Error getting service records: " << e.what() << std::endl;
+    }
+    return RowViews<ServiceRecordView>();
+}
+
+std::optional<User> Database::getUser(const std::string& username) {
+    try {
+        auto conn = acquire();
+        pqxx::work txn(*conn);
+        limitToDeadline(txn);
+        pqxx::result result = txn.exec_params(
+            "SELECT user_id, username, password_hash, role FROM Users WHERE username=$1",
+            username
+        );
+        txn.commit();
+        if (result.empty()) {
+            return std::nullopt;
+        }
+        
+        User user;
+        user.id = result[0][0].as<int>();
+        user.username = result[0][1].as<std::string>();
+        user.password_hash = result[0][2].as<std::string>();
+        user.role = result[0][3].as<std::string>();
+        return user;
+    } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
+        std::cerr << "Error getting user: " << e.what() << std::endl;
+        return std::nullopt;
+    }
+}
+
+bool Database::updatePasswordHash(int user_id, const std::string& password_hash) {
+    try {
+        auto conn = acquire();
+        pqxx::work txn(*conn);
+        limitToDeadline(txn);
+        txn.exec_params("UPDATE Users SET password_hash=$1 WHERE user_id=$2", password_hash, user_id);
+        txn.commit();
+        return true;
+    } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
+        std::cerr << "Error updating password hash: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+std::vector<Device> Database::getAllDevices() {
+    std::vector<Device> devices;
+    try {
+        auto conn = acquire();
+        pqxx::work txn(*conn);
+        limitToDeadline(txn);
+        pqxx::result result = txn.exec(DEVICES_QUERY);
         
         for (const auto& row : result) {
-            Device d;
-            d.id = row[0].as<int>();
-            d.name = row[1].as<std::string>();
-            d.model = row[2].as<std::string>("");
-            d.purchase_date = row[3].as<std::string>("");
-            d.status = row[4].as<std::string>("active");
-            devices.push_back(d);
+            devices.push_back(deviceFromRow(row));
         }
         txn.commit();
     } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
         std::cerr << "Error getting devices: " << e.what() << std::endl;
     }
     return devices;
 }
 
-bool Database::addDevice(const Device& device) {
+std::optional<Device> Database::addDevice(const Device& device) {
     try {
+        auto conn = acquire();
         pqxx::work txn(*conn);
-        txn.exec_params(
-            "INSERT INTO Devices (name, model, purchase_date, status) VALUES ($1, $2, $3, $4)",
+        limitToDeadline(txn);
+        pqxx::result result = txn.exec_params(
+            "INSERT INTO Devices (name, model, purchase_date, status) VALUES ($1, $2, $3, $4) "
+            "RETURNING device_id, name, model, purchase_date, status",
             device.name,
             device.model,
-            device.purchase_date.empty() ? nullptr : device.purchase_date.c_str(),
+            device.purchase_date,
             device.status
         );
         txn.commit();
-        return true;
+        return deviceFromRow(result[0]);
     } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
         std::cerr << "Error adding device: " << e.what() << std::endl;
-        return false;
+        return std::nullopt;
     }
 }
 
 // Реализация недостающих методов для Device
-bool Database::updateDevice(int id, const Device& device) {
+std::optional<Device> Database::updateDevice(int id, const Device& device) {
     try {
+        auto conn = acquire();
         pqxx::work txn(*conn);
-        txn.exec_params(
-            "UPDATE Devices SET name=$1, model=$2, purchase_date=$3, status=$4 WHERE device_id=$5",
+        limitToDeadline(txn);
+        pqxx::result result = txn.exec_params(
+            "UPDATE Devices SET name=$1, model=$2, purchase_date=$3, status=$4 WHERE device_id=$5 "
+            "RETURNING device_id, name, model, purchase_date, status",
             device.name,
             device.model,
-            device.purchase_date.empty() ? nullptr : device.purchase_date.c_str(),
+            device.purchase_date,
             device.status,
             id
         );
         txn.commit();
-        return true;
+        if (result.empty()) {
+            return std::nullopt;
+        }
+        return deviceFromRow(result[0]);
     } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
         std::cerr << "Error updating device: " << e.what() << std::endl;
-        return false;
+        return std::nullopt;
     }
 }
 
 bool Database::deleteDevice(int id) {
     try {
+        auto conn = acquire();
         pqxx::work txn(*conn);
+        limitToDeadline(txn);
         txn.exec_params("DELETE FROM Devices WHERE device_id=$1", id);
         txn.commit();
         return true;
     } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
         std::cerr << "Error deleting device: " << e.what() << std::endl;
         return false;
     }
@@ -111,69 +632,79 @@ bool Database::deleteDevice(int id) {
 std::vector<ServiceType> Database::getAllServiceTypes() {
     std::vector<ServiceType> types;
     try {
+        auto conn = acquire();
         pqxx::work txn(*conn);
-        pqxx::result result = txn.exec(
-            "SELECT service_id, name, recommended_interval_months, standard_cost FROM Service_Types ORDER BY service_id"
-        );
+        limitToDeadline(txn);
+        pqxx::result result = txn.exec(SERVICE_TYPES_QUERY);
         
         for (const auto& row : result) {
-            ServiceType st;
-            st.id = row[0].as<int>();
-            st.name = row[1].as<std::string>();
-            st.recommended_interval_months = row[2].as<int>(0);
-            st.standard_cost = row[3].as<double>(0.0);
-            types.push_back(st);
+            types.push_back(serviceTypeFromRow(row));
         }
         txn.commit();
     } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
         std::cerr << "Error getting service types: " << e.what() << std::endl;
     }
     return types;
 }
 
 // Реализация недостающих методов для ServiceType
-bool Database::addServiceType(const ServiceType& type) {
+std::optional<ServiceType> Database::addServiceType(const ServiceType& type) {
     try {
+        auto conn = acquire();
         pqxx::work txn(*conn);
-        txn.exec_params(
-            "INSERT INTO Service_Types (name, recommended_interval_months, standard_cost) VALUES ($1, $2, $3)",
+        limitToDeadline(txn);
+        pqxx::result result = txn.exec_params(
+            "INSERT INTO Service_Types (name, recommended_interval_months, standard_cost) VALUES ($1, $2, $3) "
+            "RETURNING service_id, name, recommended_interval_months, standard_cost",
             type.name,
             type.recommended_interval_months,
             type.standard_cost
         );
         txn.commit();
-        return true;
+        return serviceTypeFromRow(result[0]);
     } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
         std::cerr << "Error adding service type: " << e.what() << std::endl;
-        return false;
+        return std::nullopt;
     }
 }
 
-bool Database::updateServiceType(int id, const ServiceType& type) {
+std::optional<ServiceType> Database::updateServiceType(int id, const ServiceType& type) {
     try {
+        auto conn = acquire();
         pqxx::work txn(*conn);
-        txn.exec_params(
-            "UPDATE Service_Types SET name=$1, recommended_interval_months=$2, standard_cost=$3 WHERE service_id=$4",
+        limitToDeadline(txn);
+        pqxx::result result = txn.exec_params(
+            "UPDATE Service_Types SET name=$1, recommended_interval_months=$2, standard_cost=$3 WHERE service_id=$4 "
+            "RETURNING service_id, name, recommended_interval_months, standard_cost",
             type.name,
             type.recommended_interval_months,
             type.standard_cost,
             id
         );
         txn.commit();
-        return true;
+        if (result.empty()) {
+            return std::nullopt;
+        }
+        return serviceTypeFromRow(result[0]);
     } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
         std::cerr << "Error updating service type: " << e.what() << std::endl;
-        return false;
+        return std::nullopt;
     }
 }
 
 bool Database::deleteServiceType(int id) {
     try {
+        auto conn = acquire();
         pqxx::work txn(*conn);
+        limitToDeadline(txn);
         txn.exec_params("DELETE FROM Service_Types WHERE service_id=$1", id);
         txn.commit();
         return true;
     } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
         std::cerr << "Error deleting service type: " << e.what() << std::endl;
         return false;
     }
@@ -182,120 +713,726 @@ bool Database::deleteServiceType(int id) {
 std::vector<ServiceRecord> Database::getAllServiceRecords() {
     std::vector<ServiceRecord> records;
     try {
+        auto conn = acquire();
         pqxx::work txn(*conn);
+        limitToDeadline(txn);
         pqxx::result result = txn.exec(
-            "SELECT record_id, device_id, service_id, service_date, cost, notes, next_due_date "
-            "FROM Service_History ORDER BY service_date DESC"
+            "SELECT " SERVICE_RECORD_COLUMNS " FROM Service_History ORDER BY service_date DESC"
         );
         
         for (const auto& row : result) {
-            ServiceRecord sr;
-            sr.id = row[0].as<int>();
-            sr.device_id = row[1].as<int>();
-            sr.service_id = row[2].as<int>();
-            sr.service_date = row[3].as<std::string>();
-            sr.cost = row[4].as<double>(0.0);
-            sr.notes = row[5].as<std::string>("");
-            sr.next_due_date = row[6].as<std::string>("");
-            records.push_back(sr);
+            records.push_back(serviceRecordFromRow(row));
         }
         txn.commit();
     } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
         std::cerr << "Error getting service records: " << e.what() << std::endl;
     }
     return records;
 }
 
-bool Database::addServiceRecord(const ServiceRecord& record) {
+std::optional<ServiceRecord> Database::getServiceRecord(int id) {
     try {
+        auto conn = acquire();
         pqxx::work txn(*conn);
-        txn.exec_params(
+        limitToDeadline(txn);
+        pqxx::result result = txn.exec_params(
+            "SELECT " SERVICE_RECORD_COLUMNS " FROM Service_History WHERE record_id=$1",
+            id
+        );
+        txn.commit();
+        if (result.empty()) {
+            return std::nullopt;
+        }
+        return serviceRecordFromRow(result[0]);
+    } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
+        std::cerr << "Error getting service record: " << e.what() << std::endl;
+        return std::nullopt;
+    }
+}
+
+std::optional<ServiceRecord> Database::addServiceRecord(const ServiceRecord& record) {
+    try {
+        auto conn = acquire();
+        pqxx::work txn(*conn);
+        limitToDeadline(txn);
+        pqxx::result result = txn.exec_params(
             "INSERT INTO Service_History (device_id, service_id, service_date, cost, notes, next_due_date) "
-            "VALUES ($1, $2, $3, $4, $5, $6)",
+            "VALUES ($1, $2, $3, $4, $5, $6) "
+            "RETURNING " SERVICE_RECORD_COLUMNS,
             record.device_id,
             record.service_id,
             record.service_date,
             record.cost,
             record.notes,
-            record.next_due_date.empty() ? nullptr : record.next_due_date.c_str()
+            record.next_due_date
         );
         txn.commit();
-        return true;
+        return serviceRecordFromRow(result[0]);
     } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
         std::cerr << "Error adding service record: " << e.what() << std::endl;
-        return false;
+        return std::nullopt;
     }
 }
 
 // Реализация недостающих методов для ServiceRecord
-bool Database::updateServiceRecord(int id, const ServiceRecord& record) {
+std::optional<ServiceRecord> Database::updateServiceRecord(int id, const ServiceRecord& record) {
     try {
+        auto conn = acquire();
         pqxx::work txn(*conn);
-        txn.exec_params(
-            "UPDATE Service_History SET device_id=$1, service_id=$2, service_date=$3, cost=$4, notes=$5, next_due_date=$6 WHERE record_id=$7",
+        limitToDeadline(txn);
+        pqxx::result result = txn.exec_params(
+            "UPDATE Service_History SET device_id=$1, service_id=$2, service_date=$3, cost=$4, notes=$5, next_due_date=$6 "
+            "WHERE record_id=$7 "
+            "RETURNING " SERVICE_RECORD_COLUMNS,
             record.device_id,
             record.service_id,
             record.service_date,
             record.cost,
             record.notes,
-            record.next_due_date.empty() ? nullptr : record.next_due_date.c_str(),
+            record.next_due_date,
             id
         );
         txn.commit();
-        return true;
+        if (result.empty()) {
+            return std::nullopt;
+        }
+        return serviceRecordFromRow(result[0]);
     } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
         std::cerr << "Error updating service record: " << e.what() << std::endl;
-        return false;
+        throw;
     }
 }
 
 bool Database::deleteServiceRecord(int id) {
     try {
+        auto conn = acquire();
         pqxx::work txn(*conn);
-        txn.exec_params("DELETE FROM Service_History WHERE record_id=$1", id);
+        limitToDeadline(txn);
+        pqxx::result result = txn.exec_params("DELETE FROM Service_History WHERE record_id=$1", id);
         txn.commit();
-        return true;
+        return result.affected_rows() > 0;
     } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
         std::cerr << "Error deleting service record: " << e.what() << std::endl;
-        return false;
+        throw;
     }
 }
 
-json Database::getDetailedServiceHistory() {
+namespace {
+    // Колонки записей в виде массивов для передачи в UNNEST одним параметром на колонку
+    struct ServiceRecordColumns {
+        std::vector<int> ids;
+        std::vector<int> device_ids;
+        std::vector<int> service_ids;
+        std::vector<Date> service_dates;
+        std::vector<Money> costs;
+        std::vector<std::string> notes;
+        std::vector<Date> next_due_dates;
+        
+        explicit ServiceRecordColumns(const std::vector<ServiceRecord>& records) {
+            ids.reserve(records.size());
+            device_ids.reserve(records.size());
+            service_ids.reserve(records.size());
+            service_dates.reserve(records.size());
+            costs.reserve(records.size());
+            notes.reserve(records.size());
+            next_due_dates.reserve(records.size());
+            for (const auto& record : records) {
+                ids.push_back(record.id);
+                device_ids.push_back(record.device_id);
+                service_ids.push_back(record.service_id);
+                service_dates.push_back(record.service_date);
+                costs.push_back(record.cost);
+                notes.push_back(record.notes);
+                next_due_dates.push_back(record.next_due_date);
+            }
+        }
+    };
+}
+
+BatchResult Database::addServiceRecords(const std::vector<ServiceRecord>& records) {
+    BatchResult result;
+    try {
+        ServiceRecordColumns columns(records);
+        auto conn = acquire();
+        pqxx::work txn(*conn);
+        limitToDeadline(txn);
+        pqxx::result rows = txn.exec_params(
+            "INSERT INTO Service_History (device_id, service_id, service_date, cost, notes, next_due_date) "
+            "SELECT * FROM UNNEST($1::int[], $2::int[], $3::date[], $4::numeric[], $5::text[], $6::date[]) "
+            "RETURNING record_id",
+            columns.device_ids,
+            columns.service_ids,
+            columns.service_dates,
+            columns.costs,
+            columns.notes,
+            columns.next_due_dates
+        );
+        txn.commit();
+        
+        for (const auto& row : rows) {
+            result.ids.push_back(row[0].as<int>());
+        }
+        result.success = true;
+    } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
+        std::cerr << "Error adding service records batch: " << e.what() << std::endl;
+        result.error = e.what();
+    }
+    return result;
+}
+
+BatchResult Database::updateServiceRecords(const std::vector<ServiceRecord>& records) {
+    BatchResult result;
+    try {
+        ServiceRecordColumns columns(records);
+        auto conn = acquire();
+        pqxx::work txn(*conn);
+        limitToDeadline(txn);
+        pqxx::result rows = txn.exec_params(
+            "UPDATE Service_History sh SET "
+            "device_id = u.device_id, service_id = u.service_id, service_date = u.service_date, "
+            "cost = u.cost, notes = u.notes, next_due_date = u.next_due_date "
+            "FROM UNNEST($1::int[], $2::int[], $3::int[], $4::date[], $5::numeric[], $6::text[], $7::date[]) "
+            "AS u(record_id, device_id, service_id, service_date, cost, notes, next_due_date) "
+            "WHERE sh.record_id = u.record_id "
+            "RETURNING sh.record_id",
+            columns.ids,
+            columns.device_ids,
+            columns.service_ids,
+            columns.service_dates,
+            columns.costs,
+            columns.notes,
+            columns.next_due_dates
+        );
+        
+        // Пакет применяется целиком: отсутствующая запись отменяет все изменения
+        if (static_cast<size_t>(rows.size()) != records.size()) {
+            result.error = "Some record_id values were not found or duplicated";
+            return result;
+        }
+        txn.commit();
+        
+        for (const auto& row : rows) {
+            result.ids.push_back(row[0].as<int>());
+        }
+        result.success = true;
+    } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
+        std::cerr << "Error updating service records batch: " << e.what() << std::endl;
+        result.error = e.what();
+    }
+    return result;
+}
+
+BatchResult Database::deleteServiceRecords(const std::vector<int>& ids) {
+    BatchResult result;
+    try {
+        auto conn = acquire();
+        pqxx::work txn(*conn);
+        limitToDeadline(txn);
+        pqxx::result rows = txn.exec_params(
+            "DELETE FROM Service_History WHERE record_id = ANY($1::int[]) RETURNING record_id",
+            ids
+        );
+        
+        if (static_cast<size_t>(rows.size()) != ids.size()) {
+            result.error = "Some record_id values were not found or duplicated";
+            return result;
+        }
+        txn.commit();
+        
+        for (const auto& row : rows) {
+            result.ids.push_back(row[0].as<int>());
+        }
+        result.success = true;
+    } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
+        std::cerr << "Error deleting service records batch: " << e.what() << std::endl;
+        result.error = e.what();
+    }
+    return result;
+}
+
+ImportResult Database::importServiceRecords(const std::vector<ImportRow>& rows, bool atomic) {
+    ImportResult result;
+    result.total_rows = rows.size();
+    
+    try {
+        auto conn = acquire();
+        pqxx::work txn(*conn);
+        limitToDeadline(txn);
+        
+        // Справочники загружаются один раз, а не проверяются запросом на каждую строку
+        std::unordered_set<int> device_ids;
+        for (const auto& row : txn.exec("SELECT device_id FROM Devices")) {
+            device_ids.insert(row[0].as<int>());
+        }
+        std::unordered_set<int> service_ids;
+        for (const auto& row : txn.exec("SELECT service_id FROM Service_Types")) {
+            service_ids.insert(row[0].as<int>());
+        }
+        
+        std::vector<const ImportRow*> valid_rows;
+        valid_rows.reserve(rows.size());
+        for (const auto& row : rows) {
+            if (device_ids.count(row.record.device_id) == 0) {
+                result.errors.push_back({row.line, "Unknown device_id " + std::to_string(row.record.device_id)});
+            } else if (service_ids.count(row.record.service_id) == 0) {
+                result.errors.push_back({row.line, "Unknown service_id " + std::to_string(row.record.service_id)});
+            } else {
+                valid_rows.push_back(&row);
+            }
+        }
+        
+        if (valid_rows.empty() || (atomic && !result.errors.empty())) {
+            return result;
+        }
+        
+        auto stream = pqxx::stream_to::raw_table(
+            txn, "Service_History", "device_id, service_id, service_date, cost, notes, next_due_date");
+        for (const ImportRow* row : valid_rows) {
+            const ServiceRecord& record = row->record;
+            stream.write_values(
+                record.device_id,
+                record.service_id,
+                record.service_date,
+                record.cost,
+                record.notes,
+                record.next_due_date
+            );
+        }
+        stream.complete();
+        txn.commit();
+        
+        result.imported = valid_rows.size();
+        result.committed = true;
+    } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
+        std::cerr << "Error importing service records: " << e.what() << std::endl;
+        result.errors.push_back({0, std::string("Import aborted: ") + e.what()});
+    }
+    return result;
+}
+
+ExportResult Database::exportServiceRecords(const std::string& from, const std::string& to, int after_id,
+                                            size_t page_size,
+                                            const std::function<void(const std::vector<pqxx::zview>&)>& on_row) {
+    ExportResult result;
+    try {
+        auto conn = acquire();
+        pqxx::work txn(*conn);
+        limitToDeadline(txn);
+        
+        // COPY не принимает параметры запроса, поэтому даты (уже проверенные) экранируются
+        std::string query =
+            "SELECT record_id, device_id, service_id, service_date, cost, notes, next_due_date "
+            "FROM Service_History WHERE record_id > " + std::to_string(after_id);
+        if (!from.empty()) {
+            query += " AND service_date >= " + txn.quote(from) + "::date";
+        }
+        if (!to.empty()) {
+            query += " AND service_date <= " + txn.quote(to) + "::date";
+        }
+        // Ключ страницы — первичный ключ: продолжение не зависит от вставок и удалений
+        // между запросами (в отличие от OFFSET). Строка сверх страницы показывает, что есть следующая
+        query += " ORDER BY record_id LIMIT " + std::to_string(page_size + 1);
+        
+        auto stream = pqxx::stream_from::query(txn, query);
+        while (const auto* fields = stream.read_row()) {
+            if (result.rows == page_size) {
+                result.has_more = true;
+                continue;
+            }
+            on_row(*fields);
+            result.last_id = pqxx::from_string<int>((*fields)[0]);
+            ++result.rows;
+        }
+        stream.complete();
+        txn.commit();
+        result.success = true;
+    } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
+        std::cerr << "Error exporting service records: " << e.what() << std::endl;
+    }
+    return result;
+}
+
+namespace {
+    json maintenanceRowsToJson(const pqxx::result& rows, const char* days_field) {
+        json result = json::array();
+        for (const auto& row : rows) {
+            json item;
+            item["record_id"] = row[0].as<int>();
+            item["device_id"] = row[1].as<int>();
+            item["device_name"] = row[2].as<std::string>();
+            item["model"] = row[3].as<std::string>("");
+            item["service_name"] = row[4].as<std::string>();
+            item["service_date"] = row[5].as<Date>();
+            item["next_due_date"] = row[6].as<Date>();
+            item[days_field] = row[7].as<int>();
+            result.push_back(item);
+        }
+        return result;
+    }
+}
+
+json Database::getOverdueMaintenance() {
+    json result = json::array();
+    try {
+        auto conn = acquire();
+        pqxx::work txn(*conn);
+        limitToDeadline(txn);
+        result = maintenanceRowsToJson(txn.exec_prepared("overdue_maintenance"), "days_overdue");
+        txn.commit();
+    } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
+        std::cerr << "Error getting overdue maintenance: " << e.what() << std::endl;
+    }
+    return result;
+}
+
+json Database::getUpcomingMaintenance(int days) {
     json result = json::array();
     try {
+        auto conn = acquire();
         pqxx::work txn(*conn);
+        limitToDeadline(txn);
+        result = maintenanceRowsToJson(txn.exec_prepared("upcoming_maintenance", days), "days_until");
+        txn.commit();
+    } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
+        std::cerr << "Error getting upcoming maintenance: " << e.what() << std::endl;
+    }
+    return result;
+}
+
+std::optional<json> Database::getDeviceDetails(int id) {
+    try {
+        auto conn = acquire();
+        pqxx::work txn(*conn);
+        limitToDeadline(txn);
+        pqxx::result rows = txn.exec_prepared("device_details", id);
+        txn.commit();
+        if (rows.empty()) {
+            return std::nullopt;
+        }
+        
+        const auto& row = rows[0];
+        json device;
+        device["id"] = row[0].as<int>();
+        device["name"] = row[1].as<std::string>();
+        device["model"] = row[2].as<std::string>("");
+        device["purchase_date"] = row[3].as<Date>();
+        device["status"] = row[4].as<std::string>("active");
+        device["service_count"] = row[5].as<int>();
+        device["total_cost"] = row[6].is_null() ? json(nullptr) : json(row[6].as<Money>());
+        device["last_service_date"] = row[7].as<Date>();
+        return device;
+    } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
+        std::cerr << "Error getting device details: " << e.what() << std::endl;
+        return std::nullopt;
+    }
+}
+
+std::optional<json> Database::getDeviceHistory(int device_id, int limit, int offset) {
+    try {
+        auto conn = acquire();
+        pqxx::work txn(*conn);
+        limitToDeadline(txn);
+        pqxx::row exists = txn.exec_params1("SELECT EXISTS (SELECT 1 FROM Devices WHERE device_id = $1)", device_id);
+        if (!exists[0].as<bool>()) {
+            return std::nullopt;
+        }
+        pqxx::result rows = txn.exec_prepared("device_history", device_id, limit, offset);
+        txn.commit();
+        
+        json records = json::array();
+        for (const auto& row : rows) {
+            json record;
+            record["id"] = row[0].as<int>();
+            record["service_id"] = row[1].as<int>(0);
+            record["service_name"] = row[2].as<std::string>("");
+            record["service_date"] = row[3].as<Date>();
+            record["cost"] = row[4].as<Money>(Money());
+            record["next_due_date"] = row[5].as<Date>();
+            records.push_back(record);
+        }
+        return records;
+    } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
+        std::cerr << "Error getting device history: " << e.what() << std::endl;
+        return std::nullopt;
+    }
+}
+
+std::optional<json> Database::getDeviceStats() {
+    json result = json::array();
+    try {
+        auto conn = acquire();
+        pqxx::work txn(*conn);
+        limitToDeadline(txn);
+        // Device_Stats поддерживается триггерами, поэтому полного прохода по истории нет
         pqxx::result rows = txn.exec(
-            "SELECT "
-            "sh.record_id, "
-            "d.name as device_name, "
-            "d.model, "
-            "st.name as service_name, "
-            "sh.service_date, "
-            "sh.cost, "
-            "sh.notes, "
-            "sh.next_due_date "
-            "FROM Service_History sh "
-            "JOIN Devices d ON sh.device_id = d.device_id "
-            "JOIN Service_Types st ON sh.service_id = st.service_id "
-            "ORDER BY sh.service_date DESC"
+            "SELECT d.device_id, d.name, COALESCE(ds.service_count, 0), ds.total_cost, ds.last_service_date "
+            "FROM Devices d "
+            "LEFT JOIN Device_Stats ds ON ds.device_id = d.device_id "
+            "ORDER BY ds.total_cost DESC NULLS LAST, d.device_id"
         );
         
         for (const auto& row : rows) {
-            json record;
-            record["record_id"] = row[0].as<int>();
-            record["device_name"] = row[1].as<std::string>();
-            record["model"] = row[2].as<std::string>("");
-            record["service_name"] = row[3].as<std::string>();
-            record["service_date"] = row[4].as<std::string>();
-            record["cost"] = row[5].as<double>(0.0);
-            record["notes"] = row[6].as<std::string>("");
-            record["next_due_date"] = row[7].as<std::string>("");
-            result.push_back(record);
+            json item;
+            item["device_id"] = row[0].as<int>();
+            item["name"] = row[1].as<std::string>();
+            item["service_count"] = row[2].as<int>();
+            item["total_cost"] = row[3].is_null() ? json(nullptr) : json(row[3].as<Money>());
+            item["last_service_date"] = row[4].as<Date>();
+            result.push_back(item);
         }
         txn.commit();
     } catch (const std::exception& e) {
-        std::cerr << "Error getting detailed history: " << e.what() << std::endl;
+        rethrowIfCancelled(e);
+        std::cerr << "Error getting device stats: " << e.what() << std::endl;
+        return std::nullopt;
+    }
+    return result;
+}
+
+namespace {
+    // Совпадение — подстрока (ILIKE) или похожее слово ($1 <% поле, word_similarity);
+    // оба условия обслуживаются GIN-индексами gin_trgm_ops. Ранг — word_similarity:
+    // 1 для точного вхождения слова, меньше — для частичного или неточного
+    const char* const SEARCH_QUERY =
+        "WITH matches AS ("
+        "  SELECT 'device' AS kind, d.device_id AS id, d.device_id, d.name AS device_name, "
+        "         d.model, NULL::text AS notes, NULL::date AS service_date, "
+        "         GREATEST(word_similarity($1, d.name), word_similarity($1, COALESCE(d.model, ''))) AS rank "
+        "  FROM Devices d "
+        "  WHERE d.name ILIKE $2 OR d.model ILIKE $2 OR $1 <% d.name OR $1 <% d.model "
+        "  UNION ALL "
+        "  SELECT 'service_record', sh.record_id, sh.device_id, d.name, "
+        "         d.model, sh.notes, sh.service_date, word_similarity($1, sh.notes) "
+        "  FROM Service_History sh "
+        "  JOIN Devices d ON d.device_id = sh.device_id "
+        "  WHERE sh.notes ILIKE $2 OR $1 <% sh.notes"
+        ") "
+        "SELECT kind, id, device_id, device_name, model, notes, service_date, rank, COUNT(*) OVER () "
+        "FROM matches "
+        "ORDER BY rank DESC, kind, id DESC "
+        "LIMIT $3 OFFSET $4";
+}
+
+json Database::search(const std::string& text, int limit, int offset) {
+    json result;
+    result["total"] = 0;
+    result["results"] = json::array();
+    try {
+        auto conn = acquire();
+        pqxx::work txn(*conn);
+        limitToDeadline(txn);
+        pqxx::result rows = txn.exec_params(SEARCH_QUERY, text, containsPattern(text), limit, offset);
+        
+        for (const auto& row : rows) {
+            json item;
+            std::string kind = row[0].as<std::string>();
+            item["type"] = kind;
+            item["id"] = row[1].as<int>();
+            item["device_id"] = row[2].as<int>();
+            item["device_name"] = row[3].as<std::string>();
+            item["model"] = row[4].as<std::string>("");
+            if (kind == "service_record") {
+                item["notes"] = row[5].as<std::string>("");
+                item["service_date"] = row[6].as<Date>();
+            }
+            item["rank"] = row[7].as<double>();
+            result["results"].push_back(item);
+        }
+        // Общее число совпадений (для пагинации) — в каждой строке страницы
+        if (!rows.empty()) {
+            result["total"] = rows[0][8].as<long long>();
+        }
+        txn.commit();
+    } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
+        std::cerr << "Error searching: " << e.what() << std::endl;
     }
     return result;
 }
+
+DetailedHistory Database::getDetailedServiceHistory(const HistoryQuery& query,
+                                                    std::pmr::memory_resource* resource) {
+    SqlFilter filter;
+    if (!query.device_ids.empty()) {
+        filter.require("sh.device_id = ANY(" + filter.bind(pqxx::to_string(query.device_ids)) + "::int[])");
+    }
+    if (!query.service_ids.empty()) {
+        filter.require("sh.service_id = ANY(" + filter.bind(pqxx::to_string(query.service_ids)) + "::int[])");
+    }
+    if (!query.from.isNull()) {
+        filter.require("sh.service_date >= " + filter.bind(query.from.toString()) + "::date");
+    }
+    if (!query.to.isNull()) {
+        filter.require("sh.service_date <= " + filter.bind(query.to.toString()) + "::date");
+    }
+    if (query.min_cost) {
+        filter.require("sh.cost >= " + filter.bind(query.min_cost->toString()) + "::numeric");
+    }
+    if (query.max_cost) {
+        filter.require("sh.cost <= " + filter.bind(query.max_cost->toString()) + "::numeric");
+    }
+    if (!query.search.empty()) {
+        std::string pattern = filter.bind(containsPattern(query.search));
+        filter.require("(d.name ILIKE " + pattern + " OR d.model ILIKE " + pattern + ")");
+    }
+    
+    const char* column = findSortColumn(HISTORY_SORT_KEYS, query.sort);
+    std::string sql = DETAILED_HISTORY_SELECT + filter.clause() +
+                      orderAndPage(filter, column ? column : "sh.service_date", "sh.record_id",
+                                   query.descending, query.limit, query.offset);
+    
+    auto start_time = std::chrono::steady_clock::now();
+    DetailedHistory history(resource);
+    if (binary_results) {
+        getDetailedServiceHistoryBinary(history, sql, filter.params());
+    } else {
+        getDetailedServiceHistoryText(history, sql, filter.params());
+    }
+    
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+    MetricsRegistry::getInstance().recordDbQueryDuration("detailed_history", binary_results ? "binary" : "text",
+                                                         elapsed.count());
+    return history;
+}
+
+void Database::getDetailedServiceHistoryText(DetailedHistory& history, const std::string& query,
+                                             const std::vector<std::string>& params) {
+    try {
+        auto conn = acquire();
+        pqxx::work txn(*conn);
+        limitToDeadline(txn);
+        history.text_rows = txn.exec_params(query, toParams(params));
+        txn.commit();
+        
+        history.records.reserve(history.text_rows.size());
+        for (const auto& row : history.text_rows) {
+            DetailedRecordView record;
+            record.record_id = row[0].as<int>();
+            record.device_name = row[1].view();
+            record.model = viewOrEmpty(row[2]);
+            record.service_name = row[3].view();
+            record.service_date = row[4].as<Date>();
+            record.cost = row[5].as<Money>(Money());
+            record.notes = viewOrEmpty(row[6]);
+            record.next_due_date = row[7].as<Date>();
+            history.records.push_back(record);
+        }
+    } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
+        history.records.clear();
+        std::cerr << "Error getting detailed history: " << e.what() << std::endl;
+    }
+}
+
+void Database::getDetailedServiceHistoryBinary(DetailedHistory& history, const std::string& query,
+                                               const std::vector<std::string>& params) {
+    try {
+        // Запрос идёт через PGconn арендованного соединения пула, отдельного сеанса нет.
+        // Срок запроса, как в limitToDeadline, действует только внутри транзакции
+        auto conn = acquire();
+        pg_binary::Connection binary_conn(conn.raw());
+        pg_binary::ReadOnlyTransaction txn(binary_conn);
+        if (auto remaining = RequestDeadline::remaining()) {
+            txn.setStatementTimeout(*remaining);
+        }
+        history.binary_rows = std::make_shared<pg_binary::Result>(txn.exec(query, params));
+        txn.commit();
+        const pg_binary::Result& rows = *history.binary_rows;
+        rows.expectTypes({pg_binary::INT4_OID, pg_binary::TEXT_OID, pg_binary::TEXT_OID, pg_binary::TEXT_OID,
+                          pg_binary::DATE_OID, pg_binary::NUMERIC_OID, pg_binary::TEXT_OID, pg_binary::DATE_OID});
+        
+        history.records.reserve(static_cast<size_t>(rows.rows()));
+        for (int i = 0; i < rows.rows(); ++i) {
+            DetailedRecordView record;
+            record.record_id = rows.int4(i, 0);
+            record.device_name = rows.text(i, 1);
+            // model и notes допускают NULL: text() отдаёт для них пустую строку, как viewOrEmpty
+            record.model = rows.text(i, 2);
+            record.service_name = rows.text(i, 3);
+            record.service_date = rows.date(i, 4);
+            record.cost = rows.numeric(i, 5);
+            record.notes = rows.text(i, 6);
+            record.next_due_date = rows.date(i, 7);
+            history.records.push_back(record);
+        }
+    } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
+        history.records.clear();
+        std::cerr << "Error getting detailed history (binary): " << e.what() << std::endl;
+    }
+}
+
+json Database::getDashboard(int history_limit) {
+    json dashboard;
+    dashboard["database_connected"] = false;
+    dashboard["devices"] = json::array();
+    dashboard["service_types"] = json::array();
+    dashboard["recent_history"] = json::array();
+    dashboard["counts"] = {{"devices", 0}, {"service_types", 0}, {"service_history", 0}};
+    
+    try {
+        // Сегмент — отдельная транзакция REPEATABLE READ только для чтения: все части ответа
+        // читаются из одного снимка. Срок запроса передаётся явно: пакет выполняет поток батчера
+        pg_binary::PipelineSegment segment;
+        segment.queries = {
+            {DEVICES_QUERY, {}},
+            {SERVICE_TYPES_QUERY, {}},
+            {std::string(DETAILED_HISTORY_QUERY) + " LIMIT $1::int", {std::to_string(history_limit)}},
+            {COUNTS_QUERY, {}}
+        };
+        segment.statement_timeout = RequestDeadline::remaining();
+        
+        auto start_time = std::chrono::steady_clock::now();
+        auto results = pipeline->execute(std::move(segment));
+        
+        const pg_binary::Result& devices = results[0];
+        devices.expectTypes({pg_binary::INT4_OID, pg_binary::TEXT_OID, pg_binary::TEXT_OID, pg_binary::DATE_OID,
+                             pg_binary::TEXT_OID});
+        for (int i = 0; i < devices.rows(); ++i) {
+            dashboard["devices"].push_back(deviceToJson(devices, i));
+        }
+        
+        const pg_binary::Result& types = results[1];
+        types.expectTypes({pg_binary::INT4_OID, pg_binary::TEXT_OID, pg_binary::INT4_OID, pg_binary::NUMERIC_OID});
+        for (int i = 0; i < types.rows(); ++i) {
+            dashboard["service_types"].push_back(serviceTypeToJson(types, i));
+        }
+        
+        const pg_binary::Result& history = results[2];
+        history.expectTypes({pg_binary::INT4_OID, pg_binary::TEXT_OID, pg_binary::TEXT_OID, pg_binary::TEXT_OID,
+                             pg_binary::DATE_OID, pg_binary::NUMERIC_OID, pg_binary::TEXT_OID, pg_binary::DATE_OID});
+        for (int i = 0; i < history.rows(); ++i) {
+            dashboard["recent_history"].push_back(detailedRecordToJson(history, i));
+        }
+        
+        const pg_binary::Result& counts = results[3];
+        counts.expectTypes({pg_binary::INT8_OID, pg_binary::INT8_OID, pg_binary::INT8_OID});
+        dashboard["counts"]["devices"] = counts.int8(0, 0);
+        dashboard["counts"]["service_types"] = counts.int8(0, 1);
+        dashboard["counts"]["service_history"] = counts.int8(0, 2);
+        dashboard["database_connected"] = true;
+        
+        auto elapsed = std::chrono::steady_clock::now() - start_time;
+        MetricsRegistry::getInstance().recordDbQueryDuration("dashboard", "pipeline",
+                                                             std::chrono::duration<double>(elapsed).count());
+    } catch (const std::exception& e) {
+        rethrowIfCancelled(e);
+        std::cerr << "Error getting dashboard: " << e.what() << std::endl;
+    }
+    
+    return dashboard;
+}
\ No newline at end of file
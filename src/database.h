@@ -1,8 +1,18 @@
 #pragma once
+#include "date.h"
+#include "money.h"
 #include <pqxx/pqxx>
+#include <libpq-fe.h>
+#include <chrono>
 #include <string>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory_resource>
+#include <optional>
+#include <string_view>
 #include <nlohmann/json.hpp>
 
 using json = nlohmann::json;
@@ -11,7 +21,7 @@ struct Device {
     int id;
     std::string name;
     std::string model;
-    std::string purchase_date;
+    Date purchase_date;
     std::string status;
 };
 
@@ -19,48 +29,332 @@ struct ServiceType {
     int id;
     std::string name;
     int recommended_interval_months;
-    double standard_cost;
+    Money standard_cost;
+};
+
+struct User {
+    int id;
+    std::string username;
+    std::string password_hash;
+    std::string role;
 };
 
 struct ServiceRecord {
     int id;
     int device_id;
     int service_id;
-    std::string service_date;
-    double cost;
+    Date service_date;
+    Money cost;
     std::string notes;
-    std::string next_due_date;
+    Date next_due_date;
+};
+
+// Представления строк без владения данными: строковые поля указывают в буфер
+// pqxx::result, который удерживается RowViews. Действительны, пока жив RowViews
+struct DeviceView {
+    int id;
+    std::string_view name;
+    std::string_view model;
+    Date purchase_date;
+    std::string_view status;
+    
+    static DeviceView fromRow(const pqxx::row& row);
+};
+
+struct ServiceTypeView {
+    int id;
+    std::string_view name;
+    int recommended_interval_months;
+    Money standard_cost;
+    
+    static ServiceTypeView fromRow(const pqxx::row& row);
+};
+
+struct ServiceRecordView {
+    int id;
+    int device_id;
+    int service_id;
+    Date service_date;
+    Money cost;
+    std::string_view notes;
+    Date next_due_date;
+    
+    static ServiceRecordView fromRow(const pqxx::row& row);
+};
+
+// Результат запроса, перебираемый как последовательность View без копирования полей
+template<typename View>
+class RowViews {
+private:
+    pqxx::result result;
+    
+public:
+    class iterator {
+    private:
+        pqxx::result::const_iterator it;
+        
+    public:
+        explicit iterator(pqxx::result::const_iterator it) : it(it) {}
+        View operator*() const { return View::fromRow(*it); }
+        iterator& operator++() {
+            ++it;
+            return *this;
+        }
+        bool operator!=(const iterator& other) const { return it != other.it; }
+    };
+    
+    RowViews() = default;
+    explicit RowViews(pqxx::result result) : result(std::move(result)) {}
+    
+    iterator begin() const { return iterator(result.begin()); }
+    iterator end() const { return iterator(result.end()); }
+    size_t size() const { return static_cast<size_t>(result.size()); }
+    bool empty() const { return result.empty(); }
+};
+
+// Строка детализированной истории (JOIN с устройствами и типами услуг);
+// NULL в текстовых колонках — пустая строка
+struct DetailedRecordView {
+    int record_id;
+    std::string_view device_name;
+    std::string_view model;
+    std::string_view service_name;
+    Date service_date;
+    Money cost;
+    std::string_view notes;
+    Date next_due_date;
+};
+
+namespace pg_binary {
+    class Result;
+}
+
+class PipelineBatcher;
+
+// Детализированная история: результат запроса (текстовый или бинарный) и представления
+// его строк; представления действительны, пока жив DetailedHistory. Вектор представлений
+// размещается в переданном ресурсе (арене запроса)
+class DetailedHistory {
+private:
+    friend class Database;
+    pqxx::result text_rows;
+    std::shared_ptr<pg_binary::Result> binary_rows;
+    
+public:
+    std::pmr::vector<DetailedRecordView> records;
+    
+    explicit DetailedHistory(std::pmr::memory_resource* resource) : records(resource) {}
+};
+
+// Фильтр и сортировка списка устройств (GET /api/devices). Пустые поля — без ограничения.
+// Значения проверяются обработчиком, ключи сортировки — Database::isDeviceSortKey
+struct DeviceQuery {
+    std::vector<int32_t> ids;
+    std::string status;
+    std::string search;          // подстрока name/model без учёта регистра
+    std::string sort = "id";
+    bool descending = false;
+    int limit = 0;               // 0 — все строки
+    int offset = 0;
+};
+
+// Фильтр и сортировка детализированной истории (GET /api/service-history)
+struct HistoryQuery {
+    std::vector<int32_t> device_ids;
+    std::vector<int32_t> service_ids;
+    Date from;
+    Date to;
+    std::optional<Money> min_cost;
+    std::optional<Money> max_cost;
+    std::string search;          // подстрока названия/модели устройства
+    std::string sort = "date";
+    bool descending = true;
+    int limit = 0;
+    int offset = 0;
+};
+
+// Строка массового импорта истории обслуживания (line — номер строки во входных данных)
+struct ImportRow {
+    size_t line;
+    ServiceRecord record;
+};
+
+struct ImportRowError {
+    size_t line;
+    std::string error;
+};
+
+struct ImportResult {
+    size_t total_rows = 0;
+    size_t imported = 0;
+    bool committed = false;
+    std::vector<ImportRowError> errors;
+};
+
+// Результат страницы выгрузки: has_more — после last_id есть ещё строки
+struct ExportResult {
+    bool success = false;
+    bool has_more = false;
+    size_t rows = 0;
+    int last_id = 0;
+};
+
+// Результат пакетной операции: при ошибке вся транзакция откатывается
+struct BatchResult {
+    bool success = false;
+    std::vector<int> ids;
+    std::string error;
 };
 
 class Database {
+public:
+    // Соединение пула и его PGconn для запросов libpq (pg_binary); PGconn принадлежит conn
+    struct PooledConnection {
+        std::unique_ptr<pqxx::connection> conn;
+        PGconn* raw = nullptr;
+    };
+    
+    // RAII-аренда соединения из пула: возвращает соединение в пул при разрушении
+    class ConnectionLease {
+    private:
+        Database* owner;
+        PooledConnection* pooled;
+        
+    public:
+        ConnectionLease(Database* owner, PooledConnection* pooled) : owner(owner), pooled(pooled) {}
+        ConnectionLease(ConnectionLease&& other) noexcept : owner(other.owner), pooled(other.pooled) {
+            other.pooled = nullptr;
+        }
+        ConnectionLease(const ConnectionLease&) = delete;
+        ConnectionLease& operator=(const ConnectionLease&) = delete;
+        ~ConnectionLease();
+        
+        pqxx::connection& operator*() const { return *pooled->conn; }
+        pqxx::connection* operator->() const { return pooled->conn.get(); }
+        
+        // Тот же сеанс для libpq; транзакция pqxx на нём в это время не открыта
+        PGconn* raw() const { return pooled->raw; }
+    };
+    
 private:
-    std::unique_ptr<pqxx::connection> conn;
+    // Пул соединений: pqxx::connection не потокобезопасен,
+    // поэтому каждый поток-исполнитель берёт собственное соединение.
+    // Ёмкость резервируется заранее: idle_connections хранит указатели на элементы
+    std::vector<PooledConnection> connections;
+    std::vector<PooledConnection*> idle_connections;
+    std::mutex pool_mutex;
+    std::condition_variable pool_cv;
+    
+    // Бинарный формат результатов (libpq) для тяжёлых выборок, включается в конфигурации
+    bool binary_results = false;
+    
+    // Общие пакеты pipeline libpq для запросов разных HTTP-запросов (getDashboard);
+    // пакет выполняется на соединении из пула
+    std::unique_ptr<PipelineBatcher> pipeline;
+    
+    void getDetailedServiceHistoryText(DetailedHistory& history, const std::string& query,
+                                       const std::vector<std::string>& params);
+    void getDetailedServiceHistoryBinary(DetailedHistory& history, const std::string& query,
+                                         const std::vector<std::string>& params);
+    
+    ConnectionLease acquire();
+    void release(PooledConnection* pooled);
+    void prepareStatements(pqxx::connection& conn);
     
 public:
-    Database(const std::string& conn_str);
+    Database(const std::string& conn_str, size_t pool_size = 4);
     ~Database();
     
     bool connect();
     bool testConnection();
     
+    // Применение миграций схемы (migrations.h) и подготовка запросов на всех соединениях;
+    // версия схемы или -1 при ошибке
+    int migrate();
+    size_t poolSize() const { return connections.size(); }
+    void setBinaryResults(bool enabled) { binary_results = enabled; }
+    
+    // Окно сбора пакета pipeline и наибольшее число сегментов (HTTP-запросов) в пакете
+    void setPipelineSettings(std::chrono::microseconds window, size_t max_batch);
+    
+    // Методы записи возвращают созданную/обновлённую сущность (RETURNING),
+    // std::nullopt — ошибка или запись не найдена
+    
+    // Списки без копирования полей (для сериализации прямо в ответ)
+    RowViews<DeviceView> getDeviceViews(const DeviceQuery& query = DeviceQuery());
+    RowViews<ServiceTypeView> getServiceTypeViews();
+    RowViews<ServiceRecordView> getServiceRecordViews();
+    
+    // Пользователи (хеш пароля проверяет вызывающий, см. auth.h)
+    std::optional<User> getUser(const std::string& username);
+    bool updatePasswordHash(int user_id, const std::string& password_hash);
+    
     // Устройства
     std::vector<Device> getAllDevices();
-    bool addDevice(const Device& device);
-    bool updateDevice(int id, const Device& device);
+    std::optional<Device> addDevice(const Device& device);
+    std::optional<Device> updateDevice(int id, const Device& device);
     bool deleteDevice(int id);
     
     // Типы услуг
     std::vector<ServiceType> getAllServiceTypes();
-    bool addServiceType(const ServiceType& type);
-    bool updateServiceType(int id, const ServiceType& type);
+    std::optional<ServiceType> addServiceType(const ServiceType& type);
+    std::optional<ServiceType> updateServiceType(int id, const ServiceType& type);
     bool deleteServiceType(int id);
     
     // История обслуживания
     std::vector<ServiceRecord> getAllServiceRecords();
-    bool addServiceRecord(const ServiceRecord& record);
-    bool updateServiceRecord(int id, const ServiceRecord& record);
+    std::optional<ServiceRecord> getServiceRecord(int id);
+    std::optional<ServiceRecord> addServiceRecord(const ServiceRecord& record);
+    // Изменение и удаление по id: nullopt/false — записи нет. Ошибки БД не перехватываются
+    // (исключение), чтобы обработчик отличал их от «не найдено»
+    std::optional<ServiceRecord> updateServiceRecord(int id, const ServiceRecord& record);
     bool deleteServiceRecord(int id);
     
-    // Получение детализированной истории с JOIN
-    json getDetailedServiceHistory();
+    // Пакетные операции: один многострочный запрос (UNNEST массивов) и один commit.
+    // ids — record_id затронутых записей (для создания — в порядке входных записей)
+    BatchResult addServiceRecords(const std::vector<ServiceRecord>& records);
+    BatchResult updateServiceRecords(const std::vector<ServiceRecord>& records);
+    BatchResult deleteServiceRecords(const std::vector<int>& ids);
+    
+    // Массовый импорт через COPY (pqxx::stream_to) в одной транзакции.
+    // Строки со ссылками на несуществующие устройства/типы услуг попадают в errors;
+    // при atomic == true любая ошибка отменяет весь импорт
+    ImportResult importServiceRecords(const std::vector<ImportRow>& rows, bool atomic);
+    
+    // Страница выгрузки через COPY ... TO STDOUT: строки с record_id > after_id по возрастанию,
+    // on_row вызывается не больше page_size раз. Пустые from/to — без ограничения по дате
+    ExportResult exportServiceRecords(const std::string& from, const std::string& to, int after_id,
+                                      size_t page_size,
+                                      const std::function<void(const std::vector<pqxx::zview>&)>& on_row);
+    
+    // Получение детализированной истории с JOIN; представления строк — в resource
+    DetailedHistory getDetailedServiceHistory(const HistoryQuery& query, std::pmr::memory_resource* resource);
+    
+    // Допустимые ключи сортировки списков (остальные значения в SQL не попадают)
+    static bool isDeviceSortKey(const std::string& key);
+    static bool isHistorySortKey(const std::string& key);
+    
+    // Просроченное и ближайшее (в пределах days дней) обслуживание активных устройств
+    json getOverdueMaintenance();
+    json getUpcomingMaintenance(int days);
+    
+    // Статистика затрат по устройствам из агрегатной таблицы Device_Stats; nullopt — ошибка БД
+    std::optional<json> getDeviceStats();
+    
+    // Устройство со статистикой обслуживания; nullopt — устройства нет (или ошибка БД)
+    std::optional<json> getDeviceDetails(int id);
+    
+    // История одного устройства, новые записи первыми (без заметок: колонки покрывающего
+    // индекса idx_history_device_covering); nullopt — устройства нет
+    std::optional<json> getDeviceHistory(int device_id, int limit, int offset);
+    
+    // Поиск по названиям и моделям устройств и заметкам истории (pg_trgm).
+    // Результаты упорядочены по релевантности: {"total": N, "results": [...]}
+    json search(const std::string& text, int limit, int offset);
+    
+    // Данные главной страницы: устройства, типы услуг, последние записи истории
+    // и счётчики из одного снимка БД (REPEATABLE READ, только чтение). Четыре выборки —
+    // сегмент общего пакета pipeline: вместе с сегментами одновременных запросов
+    // они занимают одно соединение и один round trip (PipelineBatcher)
+    json getDashboard(int history_limit);
 };
\ No newline at end of file
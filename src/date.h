@@ -0,0 +1,180 @@
+#pragma once
+#include <pqxx/pqxx>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <compare>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Компактная дата: число дней от 1970-01-01 (4 байта вместо std::string).
+// Значение по умолчанию — NULL (нет даты); NULL меньше любой даты.
+// Разбор и вывод формата ISO-8601 YYYY-MM-DD без выделения памяти.
+class Date {
+public:
+    static constexpr int32_t NULL_DAYS = std::numeric_limits<int32_t>::min();
+    static constexpr size_t TEXT_SIZE = 10;
+
+    constexpr Date() = default;
+    constexpr explicit Date(std::chrono::sys_days day)
+        : days_(static_cast<int32_t>(day.time_since_epoch().count())) {}
+
+    static constexpr Date fromDays(int32_t days) {
+        Date date;
+        date.days_ = days;
+        return date;
+    }
+
+    static Date today() {
+        return Date(std::chrono::floor<std::chrono::days>(std::chrono::system_clock::now()));
+    }
+
+    constexpr bool isNull() const { return days_ == NULL_DAYS; }
+    constexpr int32_t days() const { return days_; }
+    constexpr std::chrono::sys_days sysDays() const { return std::chrono::sys_days{std::chrono::days{days_}}; }
+    constexpr std::chrono::year_month_day ymd() const { return std::chrono::year_month_day{sysDays()}; }
+
+    // YYYY-MM-DD с проверкой существования дня в календаре
+    static constexpr std::optional<Date> parse(std::string_view text) {
+        if (text.size() != TEXT_SIZE || text[4] != '-' || text[7] != '-') {
+            return std::nullopt;
+        }
+
+        int value[3] = {0, 0, 0};
+        const size_t starts[3] = {0, 5, 8};
+        const size_t lengths[3] = {4, 2, 2};
+        for (size_t part = 0; part < 3; ++part) {
+            for (size_t i = starts[part]; i < starts[part] + lengths[part]; ++i) {
+                if (text[i] < '0' || text[i] > '9') {
+                    return std::nullopt;
+                }
+                value[part] = value[part] * 10 + (text[i] - '0');
+            }
+        }
+
+        std::chrono::year_month_day ymd{std::chrono::year{value[0]},
+                                        std::chrono::month{static_cast<unsigned>(value[1])},
+                                        std::chrono::day{static_cast<unsigned>(value[2])}};
+        if (!ymd.ok()) {
+            return std::nullopt;
+        }
+        return Date(std::chrono::sys_days{ymd});
+    }
+
+    // Записывает TEXT_SIZE символов в out, возвращает указатель за последним
+    constexpr char* format(char* out) const {
+        auto date = ymd();
+        int year = static_cast<int>(date.year());
+        unsigned month = static_cast<unsigned>(date.month());
+        unsigned day = static_cast<unsigned>(date.day());
+
+        out[0] = static_cast<char>('0' + year / 1000 % 10);
+        out[1] = static_cast<char>('0' + year / 100 % 10);
+        out[2] = static_cast<char>('0' + year / 10 % 10);
+        out[3] = static_cast<char>('0' + year % 10);
+        out[4] = '-';
+        out[5] = static_cast<char>('0' + month / 10);
+        out[6] = static_cast<char>('0' + month % 10);
+        out[7] = '-';
+        out[8] = static_cast<char>('0' + day / 10);
+        out[9] = static_cast<char>('0' + day % 10);
+        return out + TEXT_SIZE;
+    }
+
+    // Пустая строка для NULL
+    std::string toString() const {
+        if (isNull()) {
+            return "";
+        }
+        std::string text(TEXT_SIZE, '\0');
+        format(text.data());
+        return text;
+    }
+
+    // Сдвиг на целое число месяцев; день ограничивается последним днём месяца
+    constexpr Date addMonths(int months) const {
+        using namespace std::chrono;
+        auto date = ymd();
+        year_month shifted = year_month{date.year(), date.month()} + std::chrono::months{months};
+        day last = year_month_day_last{shifted.year(), month_day_last{shifted.month()}}.day();
+        return Date(sys_days{shifted / std::min(date.day(), last)});
+    }
+
+    friend constexpr auto operator<=>(const Date&, const Date&) = default;
+
+private:
+    int32_t days_ = NULL_DAYS;
+};
+
+// JSON: строка YYYY-MM-DD или null; пустая строка во входных данных — тоже NULL
+inline void to_json(nlohmann::json& j, const Date& date) {
+    if (date.isNull()) {
+        j = nullptr;
+    } else {
+        j = date.toString();
+    }
+}
+
+inline void from_json(const nlohmann::json& j, Date& date) {
+    if (j.is_null()) {
+        date = Date();
+        return;
+    }
+    const auto& text = j.get_ref<const std::string&>();
+    if (text.empty()) {
+        date = Date();
+        return;
+    }
+    auto parsed = Date::parse(text);
+    if (!parsed) {
+        throw std::invalid_argument("Invalid date: '" + text + "' (expected YYYY-MM-DD)");
+    }
+    date = *parsed;
+}
+
+// Преобразование Date <-> текстовое представление PostgreSQL (DateStyle ISO),
+// NULL столбца соответствует Date()
+namespace pqxx {
+    template<> struct nullness<Date> {
+        static constexpr bool has_null = true;
+        static constexpr bool always_null = false;
+
+        static constexpr bool is_null(const Date& date) { return date.isNull(); }
+        [[nodiscard]] static constexpr Date null() { return Date(); }
+    };
+
+    template<> struct string_traits<Date> {
+        static constexpr bool converts_to_string = true;
+        static constexpr bool converts_from_string = true;
+
+        static Date from_string(std::string_view text) {
+            auto parsed = Date::parse(text);
+            if (!parsed) {
+                throw conversion_error("Could not convert '" + std::string(text) + "' to Date");
+            }
+            return *parsed;
+        }
+
+        static char* into_buf(char* begin, char* end, const Date& date) {
+            if (end - begin < static_cast<std::ptrdiff_t>(Date::TEXT_SIZE + 1)) {
+                throw conversion_overrun("Not enough buffer space for Date");
+            }
+            char* next = date.format(begin);
+            *next++ = '\0';
+            return next;
+        }
+
+        static zview to_buf(char* begin, char* end, const Date& date) {
+            char* next = into_buf(begin, end, date);
+            return zview{begin, static_cast<std::size_t>(next - begin - 1)};
+        }
+
+        static constexpr std::size_t size_buffer(const Date&) noexcept { return Date::TEXT_SIZE + 1; }
+    };
+
+    template<> inline const std::string type_name<Date>{"Date"};
+}
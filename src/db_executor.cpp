@@ -0,0 +1,64 @@
+#include "db_executor.h"
+#include <iostream>
+
+DbExecutor::DbExecutor(size_t thread_count) {
+    if (thread_count == 0) {
+        thread_count = 1;
+    }
+    
+    workers.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+DbExecutor::~DbExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        stopping = true;
+    }
+    queue_cv.notify_all();
+    
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void DbExecutor::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        tasks.push_back(std::move(task));
+    }
+    queue_cv.notify_one();
+}
+
+size_t DbExecutor::queueDepth() {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    return tasks.size();
+}
+
+void DbExecutor::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_cv.wait(lock, [this] { return stopping || !tasks.empty(); });
+            
+            // Перед остановкой дорабатываем уже поставленные задачи
+            if (stopping && tasks.empty()) {
+                return;
+            }
+            
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        
+        try {
+            task();
+        } catch (const std::exception& e) {
+            std::cerr << "DB executor task failed: " << e.what() << std::endl;
+        }
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Пул потоков для блокирующей работы с БД.
+// Обработчики Crow передают сюда задачи, чтобы синхронные вызовы libpqxx
+// не занимали I/O потоки сервера (и не блокировали /metrics и статику).
+// Размер пула совпадает с размером пула соединений Database.
+class DbExecutor {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    bool stopping = false;
+    
+    void workerLoop();
+    
+public:
+    explicit DbExecutor(size_t thread_count);
+    ~DbExecutor();
+    
+    DbExecutor(const DbExecutor&) = delete;
+    DbExecutor& operator=(const DbExecutor&) = delete;
+    
+    void submit(std::function<void()> task);
+    
+    size_t threadCount() const { return workers.size(); }
+    size_t queueDepth();
+};
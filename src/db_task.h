@@ -0,0 +1,22 @@
+#pragma once
+#include "concurrency_limiter.h"
+#include "request_deadline.h"
+#include <functional>
+#include <optional>
+
+// Задача запроса к БД для пула DbExecutor. Слот адаптивного лимита (если он занят
+// при постановке в очередь) освобождается при любом исходе — в том числе когда срок
+// запроса истёк, пока задача ждала в очереди, и work не вызывается.
+// Срок (RequestDeadline::Scope) открывает вызывающий поток пула.
+template<typename Result>
+std::function<Result()> admitDbTask(std::function<Result()> work, ConcurrencyLimiter* limiter,
+                                    ConcurrencyLimiter::Clock::time_point acquired_at) {
+    return [work = std::move(work), limiter, acquired_at]() {
+        std::optional<ConcurrencyLimiter::Permit> permit;
+        if (limiter) {
+            permit.emplace(*limiter, acquired_at);
+        }
+        RequestDeadline::check("queue");
+        return work();
+    };
+}
@@ -0,0 +1,137 @@
+#pragma once
+#include "date.h"
+#include "money.h"
+#include <charconv>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+// Потоковая запись JSON прямо в выходной буфер (тело ответа) без построения
+// дерева nlohmann::json: строки копируются из источника один раз, в out.
+// Буфер — std::pmr::string, обычно в арене запроса (RequestArena): рост буфера
+// не обращается к куче. Запятые между элементами расставляются автоматически.
+class JsonWriter {
+private:
+    std::pmr::string& out;
+    bool need_comma = false;
+
+    void separate() {
+        if (need_comma) {
+            out += ',';
+        }
+    }
+
+public:
+    explicit JsonWriter(std::pmr::string& out) : out(out) {}
+
+    JsonWriter& beginArray() {
+        separate();
+        out += '[';
+        need_comma = false;
+        return *this;
+    }
+
+    JsonWriter& endArray() {
+        out += ']';
+        need_comma = true;
+        return *this;
+    }
+
+    JsonWriter& beginObject() {
+        separate();
+        out += '{';
+        need_comma = false;
+        return *this;
+    }
+
+    JsonWriter& endObject() {
+        out += '}';
+        need_comma = true;
+        return *this;
+    }
+
+    JsonWriter& key(std::string_view name) {
+        separate();
+        appendString(out, name);
+        out += ':';
+        need_comma = false;
+        return *this;
+    }
+
+    JsonWriter& value(std::string_view text) {
+        separate();
+        appendString(out, text);
+        need_comma = true;
+        return *this;
+    }
+
+    JsonWriter& value(int number) {
+        separate();
+        char buffer[16];
+        auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), number);
+        out.append(buffer, end);
+        need_comma = true;
+        return *this;
+    }
+
+    // Дата — строка YYYY-MM-DD, NULL — null
+    JsonWriter& value(const Date& date) {
+        separate();
+        if (date.isNull()) {
+            out += "null";
+        } else {
+            char buffer[Date::TEXT_SIZE];
+            out += '"';
+            out.append(buffer, date.format(buffer));
+            out += '"';
+        }
+        need_comma = true;
+        return *this;
+    }
+
+    // Сумма — число с двумя знаками после точки
+    JsonWriter& value(const Money& money) {
+        separate();
+        char buffer[Money::MAX_TEXT_SIZE];
+        out.append(buffer, money.format(buffer));
+        need_comma = true;
+        return *this;
+    }
+
+    JsonWriter& null() {
+        separate();
+        out += "null";
+        need_comma = true;
+        return *this;
+    }
+
+    // Строка JSON в кавычках с экранированием управляющих символов;
+    // участки без спецсимволов копируются целиком. Out — std::string или std::pmr::string
+    template<typename Out>
+    static void appendString(Out& out, std::string_view value) {
+        static const char* const HEX = "0123456789abcdef";
+        out += '"';
+        size_t run_start = 0;
+        for (size_t i = 0; i < value.size(); ++i) {
+            char c = value[i];
+            if (c != '"' && c != '\\' && static_cast<unsigned char>(c) >= 0x20) {
+                continue;
+            }
+            out.append(value.data() + run_start, i - run_start);
+            run_start = i + 1;
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    out += "\\u00";
+                    out += HEX[(c >> 4) & 0xF];
+                    out += HEX[c & 0xF];
+            }
+        }
+        out.append(value.data() + run_start, value.size() - run_start);
+        out += '"';
+    }
+};
@@ -0,0 +1,100 @@
+#include "login_throttle.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Сдвиг пары окон к моменту now; после двух пустых периодов окно начинается заново
+    void advance(LoginThrottle::Window& window, LoginThrottle::Clock::duration length,
+                 LoginThrottle::Clock::time_point now) {
+        auto elapsed = now - window.started;
+        if (elapsed < length) {
+            return;
+        }
+        if (elapsed < 2 * length) {
+            window.previous = window.current;
+            window.started += length;
+        } else {
+            window.previous = 0;
+            window.started = now;
+        }
+        window.current = 0;
+    }
+}
+
+LoginThrottle::LoginThrottle(Settings settings) : settings(settings) {
+    sweeper = std::thread([this] { sweepLoop(); });
+}
+
+LoginThrottle::~LoginThrottle() {
+    {
+        std::lock_guard<std::mutex> lock(sweeper_mutex);
+        stopping = true;
+    }
+    sweeper_cv.notify_all();
+    if (sweeper.joinable()) {
+        sweeper.join();
+    }
+}
+
+std::chrono::seconds LoginThrottle::admitIp(const std::string& ip, Clock::time_point now) {
+    return admit(ips, ip, settings.max_attempts_per_ip, now);
+}
+
+std::chrono::seconds LoginThrottle::admitUser(const std::string& username, Clock::time_point now) {
+    return admit(users, username, settings.max_attempts_per_user, now);
+}
+
+std::chrono::seconds LoginThrottle::admit(ShardedMap<Window>& windows, const std::string& key,
+                                          uint32_t limit, Clock::time_point now) {
+    const Clock::duration length = settings.window;
+    const double length_seconds = std::chrono::duration<double>(length).count();
+
+    double wait_seconds = windows.update(key, [&](Window& window) {
+        advance(window, length, now);
+
+        double elapsed = std::chrono::duration<double>(now - window.started).count();
+        double estimate = window.previous * (1.0 - elapsed / length_seconds) + window.current;
+        if (estimate < limit) {
+            ++window.current;
+            return 0.0;
+        }
+
+        // Момент, когда оценка опустится ниже лимита: либо за счёт затухания
+        // предыдущего окна, либо (если текущее уже заполнено) в следующем окне
+        if (window.current < limit) {
+            double until = length_seconds * (1.0 - double(limit - window.current) / window.previous);
+            return until - elapsed;
+        }
+        double until_next = length_seconds * (1.0 - double(limit) / window.current);
+        return (length_seconds - elapsed) + until_next;
+    });
+
+    if (wait_seconds <= 0.0) {
+        return std::chrono::seconds(0);
+    }
+    return std::chrono::seconds(std::max<int64_t>(1, static_cast<int64_t>(std::ceil(wait_seconds))));
+}
+
+void LoginThrottle::forgive(const std::string& ip, const std::string& username) {
+    ips.updateExisting(ip, [](Window& window) {
+        if (window.current > 0) {
+            --window.current;
+        }
+    });
+    users.erase(username);
+}
+
+size_t LoginThrottle::sweep(Clock::time_point now) {
+    const Clock::duration stale_after = 2 * Clock::duration(settings.window);
+    auto stale = [&](const Window& window) { return now - window.started >= stale_after; };
+    return ips.eraseIf(stale) + users.eraseIf(stale);
+}
+
+void LoginThrottle::sweepLoop() {
+    std::unique_lock<std::mutex> lock(sweeper_mutex);
+    while (!sweeper_cv.wait_for(lock, settings.sweep_interval, [this] { return stopping; })) {
+        lock.unlock();
+        sweep();
+        lock.lock();
+    }
+}
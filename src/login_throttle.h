@@ -0,0 +1,65 @@
+#pragma once
+#include "sharded_map.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Защита /api/login от подбора паролей: скользящие окна попыток входа на IP
+// и на имя пользователя. Проверка IP выполняется до разбора тела запроса,
+// поэтому отклонённая попытка не стоит ни PBKDF2, ни логов, ни меток метрик.
+// Успешный вход снимает свою попытку со счётчиков. Устаревшие окна удаляет
+// фоновый поток.
+class LoginThrottle {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Settings {
+        uint32_t max_attempts_per_ip = 20;
+        uint32_t max_attempts_per_user = 5;
+        std::chrono::seconds window{300};
+        std::chrono::seconds sweep_interval{60};
+    };
+
+    // Попытки в скользящем окне приближаются двумя соседними фиксированными окнами:
+    // оценка = previous * (доля предыдущего окна, ещё попадающая в скользящее) + current
+    struct Window {
+        Clock::time_point started;
+        uint32_t previous = 0;
+        uint32_t current = 0;
+    };
+
+    explicit LoginThrottle(Settings settings);
+    ~LoginThrottle();
+
+    LoginThrottle(const LoginThrottle&) = delete;
+    LoginThrottle& operator=(const LoginThrottle&) = delete;
+
+    // Учёт попытки; 0 — попытка разрешена и засчитана, иначе — через сколько секунд повторить
+    std::chrono::seconds admitIp(const std::string& ip, Clock::time_point now = Clock::now());
+    std::chrono::seconds admitUser(const std::string& username, Clock::time_point now = Clock::now());
+
+    // Успешный вход: попытка снимается со счётчика IP, окно имени пользователя сбрасывается
+    void forgive(const std::string& ip, const std::string& username);
+
+    // Удаление окон без попыток за последние два периода; вызывается фоновым потоком
+    size_t sweep(Clock::time_point now = Clock::now());
+
+    size_t trackedKeys() { return ips.size() + users.size(); }
+
+private:
+    Settings settings;
+    ShardedMap<Window> ips;
+    ShardedMap<Window> users;
+
+    std::thread sweeper;
+    std::mutex sweeper_mutex;
+    std::condition_variable sweeper_cv;
+    bool stopping = false;
+
+    std::chrono::seconds admit(ShardedMap<Window>& windows, const std::string& key,
+                               uint32_t limit, Clock::time_point now);
+    void sweepLoop();
+};
@@ -131,6 +131,44 @@ public:
     }
 };
 
+// Текущее значение (может уменьшаться); выставляется целиком при каждом обновлении
+class Gauge {
+private:
+    double value_ = 0.0;
+    std::string name_;
+    Labels labels_;
+    mutable std::mutex mutex_;
+    
+public:
+    Gauge() {}
+    
+    Gauge(const std::string& name, const Labels& labels = Labels()) : name_(name), labels_(labels) {}
+    
+    Gauge(Gauge&& other) noexcept {
+        std::lock_guard<std::mutex> lock(other.mutex_);
+        name_ = std::move(other.name_);
+        value_ = other.value_;
+        labels_ = std::move(other.labels_);
+    }
+    
+    void set(double val) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        value_ = val;
+    }
+    
+    double value() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return value_;
+    }
+    
+    std::string format() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::stringstream ss;
+        ss << name_ << labels_.toString() << " " << std::fixed << std::setprecision(2) << value_ << "\n";
+        return ss.str();
+    }
+};
+
 class Histogram {
 private:
     double sum_ = 0.0;
@@ -288,10 +326,12 @@ private:
     // Store metrics organized by base name, then by labels
     std::unordered_map<std::string, std::map<Labels, Counter>> counters_;
     std::unordered_map<std::string, std::map<Labels, Histogram>> histograms_;
+    std::unordered_map<std::string, std::map<Labels, Gauge>> gauges_;
     
     // Track TYPE/HELP info for each metric
     std::unordered_map<std::string, std::string> counterHelps_;
     std::unordered_map<std::string, std::string> histogramHelps_;
+    std::unordered_map<std::string, std::string> gaugeHelps_;
     
     mutable std::mutex mutex_;
     bool initialized_ = false;
@@ -322,7 +362,13 @@ public:
         std::vector<std::string> methods = {"GET", "POST", "PUT", "DELETE", "PATCH"};
         std::vector<std::string> paths = {"/", "/metrics", "/api/test-db", "/api/login", 
                                            "/api/logout", "/api/devices", "/api/service-types",
-                                           "/api/service-history", "/api/service-records"};
+                                           "/api/service-history", "/api/service-records",
+                                           "/api/dashboard", "/api/import/service-history",
+                                           "/api/export/service-history", "/api/service-history/batch",
+                                           "/api/service-history/<id>", "/api/maintenance/overdue",
+                                           "/api/maintenance/upcoming", "/api/stats/devices",
+                                           "/api/analytics", "/api/search", "/api/devices/<id>",
+                                           "/api/devices/<id>/history"};
         std::vector<int> statuses = {200, 201, 400, 401, 403, 404, 500};
         
         for (const auto& method : methods) {
@@ -431,6 +477,22 @@ public:
         return labelIt->second;
     }
     
+    Gauge& getGauge(const std::string& name, const std::string& help = "",
+                    const Labels& labels = Labels()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        
+        if (!help.empty()) {
+            gaugeHelps_[name] = help;
+        }
+        
+        auto& metricMap = gauges_[name];
+        auto labelIt = metricMap.find(labels);
+        if (labelIt == metricMap.end()) {
+            labelIt = metricMap.emplace(labels, Gauge(name, labels)).first;
+        }
+        return labelIt->second;
+    }
+    
     std::string format() const {
         std::lock_guard<std::mutex> lock(mutex_);
         std::stringstream ss;
@@ -467,6 +529,17 @@ public:
             }
         }
         
+        // Output gauges with TYPE/HELP first, then values
+        for (const auto& namePair : gauges_) {
+            auto helpIt = gaugeHelps_.find(namePair.first);
+            std::string help = (helpIt != gaugeHelps_.end()) ? helpIt->second : "";
+            ss << Counter::formatTypeHelp(namePair.first, help, "gauge");
+            
+            for (const auto& labelPair : namePair.second) {
+                ss << labelPair.second.format();
+            }
+        }
+        
         return ss.str();
     }
     
@@ -497,6 +570,119 @@ public:
         counter.increment();
     }
     
+    // Время выполнения и декодирования запроса в зависимости от формата результата (text/binary)
+    void recordDbQueryDuration(const std::string& query, const std::string& format, double duration_seconds) {
+        std::map<std::string, std::string> labels;
+        labels["query"] = query;
+        labels["format"] = format;
+        
+        auto& histogram = getHistogram("db_query_duration_seconds",
+                                       "Database query execution and decoding time in seconds",
+                                       {0.001, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5},
+                                       Labels(labels));
+        histogram.observe(duration_seconds);
+    }
+    
+    // Пакет pipeline (PipelineBatcher): число сегментов (HTTP-запросов) и время выполнения
+    void recordPipelineBatch(size_t segments, double duration_seconds) {
+        getHistogram("db_pipeline_batch_segments", "Number of request segments sent in one libpq pipeline batch",
+                     {1, 2, 4, 8, 16, 32, 64}).observe(static_cast<double>(segments));
+        getHistogram("db_pipeline_batch_duration_seconds", "libpq pipeline batch execution time in seconds",
+                     {0.001, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5}).observe(duration_seconds);
+    }
+    
+    // Использование арены запроса: число выделений, байты и выход за начальный буфер потока
+    void recordArenaUsage(size_t allocations, size_t bytes, bool overflow) {
+        getCounter("request_arena_allocations_total", "Total number of allocations served by request arenas")
+            .increment(static_cast<double>(allocations));
+        getCounter("request_arena_bytes_total", "Total bytes allocated from request arenas")
+            .increment(static_cast<double>(bytes));
+        
+        std::map<std::string, std::string> labels;
+        labels["overflow"] = overflow ? "true" : "false";
+        getCounter("request_arena_requests_total", "Total number of requests that used a request arena",
+                   Labels(labels)).increment();
+    }
+    
+    // Проверка токена в AuthMiddleware: result = cache_hit|valid|invalid
+    void recordTokenVerification(const std::string& result, double duration_seconds) {
+        std::map<std::string, std::string> labels;
+        labels["result"] = result;
+        
+        auto& histogram = getHistogram("auth_token_verify_seconds",
+                                       "Bearer token verification time in seconds",
+                                       {0.0001, 0.0005, 0.001, 0.005, 0.01},
+                                       Labels(labels));
+        histogram.observe(duration_seconds);
+    }
+    
+    // Проверка пароля при входе (PBKDF2): длительность задаётся числом итераций хеша
+    void recordPasswordVerification(bool success, double duration_seconds) {
+        std::map<std::string, std::string> labels;
+        labels["success"] = success ? "true" : "false";
+        
+        auto& histogram = getHistogram("auth_password_verify_seconds",
+                                       "Password hash verification time in seconds",
+                                       {0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0},
+                                       Labels(labels));
+        histogram.observe(duration_seconds);
+    }
+    
+    // Запросы, отклонённые AuthMiddleware: reason = missing|invalid
+    void recordAuthRejection(const std::string& reason) {
+        std::map<std::string, std::string> labels;
+        labels["reason"] = reason;
+        
+        auto& counter = getCounter("auth_rejected_requests_total",
+                                   "Total number of requests rejected for missing or invalid tokens", Labels(labels));
+        counter.increment();
+    }
+    
+    // Попытка входа отклонена ограничителем (scope: ip | user); метки фиксированы,
+    // поэтому поток отклонённых попыток не раздувает число временных рядов
+    void recordLoginThrottled(const char* scope) {
+        std::map<std::string, std::string> labels;
+        labels["scope"] = scope;
+        
+        auto& counter = getCounter("login_throttled_total",
+                                   "Total number of login attempts rejected by the throttle", Labels(labels));
+        counter.increment();
+    }
+    
+    // Запрос отклонён ограничителем частоты (group из rate_limits, client: ip | token)
+    void recordRateLimited(const std::string& group, const char* client) {
+        std::map<std::string, std::string> labels;
+        labels["group"] = group;
+        labels["client"] = client;
+        
+        auto& counter = getCounter("rate_limited_requests_total",
+                                   "Total number of requests rejected by the rate limiter", Labels(labels));
+        counter.increment();
+    }
+    
+    // Адаптивный лимит одновременных запросов к БД: текущее значение и занятые слоты
+    // (обновляются при каждом сборе /metrics)
+    void recordDbConcurrency(double limit, int in_flight) {
+        getGauge("db_concurrency_limit", "Current adaptive limit of concurrent database requests").set(limit);
+        getGauge("db_requests_in_flight", "Database requests currently admitted by the limiter").set(in_flight);
+    }
+    
+    // Срок запроса истёк (stage: queue — в очереди пула, database — запрос прерван
+    // statement_timeout, serialization — перед сериализацией ответа)
+    void recordDeadlineExceeded(const std::string& stage) {
+        std::map<std::string, std::string> labels;
+        labels["stage"] = stage;
+        
+        getCounter("request_deadline_exceeded_total", "Total number of requests answered 504 after their deadline",
+                   Labels(labels)).increment();
+    }
+    
+    // Запрос отклонён с 503: лимит одновременных запросов к БД исчерпан
+    void recordDbRequestShed() {
+        getCounter("db_requests_shed_total", "Total number of requests rejected by the database concurrency limiter")
+            .increment();
+    }
+    
     void recordAuthAttempt(const std::string& username, bool success) {
         std::map<std::string, std::string> labels;
         labels["username"] = username;
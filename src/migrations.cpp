@@ -0,0 +1,225 @@
+#include "migrations.h"
+#include <iostream>
+
+namespace migrations {
+
+namespace {
+    // Ключ pg_advisory_xact_lock: несколько экземпляров сервера применяют миграции по очереди
+    const long long MIGRATION_LOCK_KEY = 0x5345525649434531;  // "SERVICE1"
+    
+    const char* const CREATE_TABLE_SQL =
+        "CREATE TABLE IF NOT EXISTS schema_migrations ("
+        "  version INT PRIMARY KEY,"
+        "  name VARCHAR(100) NOT NULL,"
+        "  applied_at TIMESTAMPTZ NOT NULL DEFAULT now()"
+        ")";
+    
+    // Единственное описание схемы сверх базовых таблиц create_db.sql / docker/init.sql.
+    // IF NOT EXISTS и OR REPLACE: объекты, созданные вручную, миграция не ломает
+    const std::vector<Migration> MIGRATIONS = {
+        {1, "history_indexes",
+         // Фильтры и сортировки списков (/api/service-history): отбор по устройству или типу
+         // работ с сортировкой по дате, диапазон дат, диапазон и сортировка по стоимости.
+         // record_id в конце ключа совпадает с порядком страниц (ORDER BY ..., record_id).
+         // Индекс по устройству покрывающий: /api/devices/<id>/history читает только его
+         // (index-only scan). idx_history_device_date с тем же ключом из ранних версий удаляется
+         "CREATE INDEX IF NOT EXISTS idx_history_device_covering "
+         "  ON Service_History(device_id, service_date DESC, record_id DESC) "
+         "  INCLUDE (service_id, cost, next_due_date);"
+         "DROP INDEX IF EXISTS idx_history_device_date;"
+         "CREATE INDEX IF NOT EXISTS idx_history_service_date "
+         "  ON Service_History(service_id, service_date DESC, record_id DESC);"
+         "CREATE INDEX IF NOT EXISTS idx_history_date "
+         "  ON Service_History(service_date DESC, record_id DESC);"
+         "CREATE INDEX IF NOT EXISTS idx_history_cost ON Service_History(cost, record_id);"},
+        {2, "trigram_search",
+         // /api/search: ILIKE '%...%' и word_similarity (<%) обслуживаются индексом
+         "CREATE EXTENSION IF NOT EXISTS pg_trgm;"
+         "CREATE INDEX IF NOT EXISTS idx_history_notes_trgm ON Service_History USING GIN (notes gin_trgm_ops);"
+         "CREATE INDEX IF NOT EXISTS idx_devices_name_trgm ON Devices USING GIN (name gin_trgm_ops);"
+         "CREATE INDEX IF NOT EXISTS idx_devices_model_trgm ON Devices USING GIN (model gin_trgm_ops);"},
+        {3, "users",
+         // Только таблица: учётные записи миграция не создаёт. Демонстрационные пользователи
+         // добавляются insert_db.sql и docker/init.sql
+         "CREATE TABLE IF NOT EXISTS Users ("
+         "  user_id SERIAL PRIMARY KEY,"
+         "  username VARCHAR(50) NOT NULL UNIQUE,"
+         "  password_hash VARCHAR(200) NOT NULL,"
+         "  role VARCHAR(20) NOT NULL DEFAULT 'user'"
+         ");"},
+        {4, "devices_status_index",
+         // Фильтр по статусу устройства в отчётах по обслуживанию и в /api/devices?status=
+         "CREATE INDEX IF NOT EXISTS idx_devices_status ON Devices(status);"},
+        {5, "device_stats",
+         // Агрегаты по устройствам: чтение статистики — O(устройств), а не O(истории).
+         // Триггеры уровня оператора с переходными таблицами: пакетная вставка или COPY
+         // обновляет агрегаты одним запросом на оператор. Запись в Service_History заблокирована
+         // до конца миграции: изменения между созданием триггеров и пересчётом не теряются
+         R"sql(
+LOCK TABLE Service_History IN SHARE ROW EXCLUSIVE MODE;
+
+CREATE TABLE IF NOT EXISTS Device_Stats (
+    device_id INT PRIMARY KEY REFERENCES Devices(device_id) ON DELETE CASCADE,
+    service_count INT NOT NULL DEFAULT 0,
+    total_cost DECIMAL(12,2) NOT NULL DEFAULT 0,
+    last_service_date DATE
+);
+
+CREATE OR REPLACE FUNCTION device_stats_refresh() RETURNS TRIGGER AS $$
+BEGIN
+    IF TG_OP IN ('DELETE', 'UPDATE') THEN
+        UPDATE Device_Stats ds SET
+            service_count = ds.service_count - o.cnt,
+            total_cost = ds.total_cost - o.cost,
+            last_service_date = CASE
+                WHEN o.max_date >= ds.last_service_date THEN
+                    (SELECT MAX(sh.service_date) FROM Service_History sh WHERE sh.device_id = ds.device_id)
+                ELSE ds.last_service_date
+            END
+        FROM (
+            SELECT device_id, COUNT(*) AS cnt, COALESCE(SUM(cost), 0) AS cost, MAX(service_date) AS max_date
+            FROM old_rows WHERE device_id IS NOT NULL GROUP BY device_id
+        ) o
+        WHERE ds.device_id = o.device_id;
+    END IF;
+
+    IF TG_OP IN ('INSERT', 'UPDATE') THEN
+        INSERT INTO Device_Stats AS ds (device_id, service_count, total_cost, last_service_date)
+        SELECT device_id, COUNT(*), COALESCE(SUM(cost), 0), MAX(service_date)
+        FROM new_rows WHERE device_id IS NOT NULL GROUP BY device_id
+        ON CONFLICT (device_id) DO UPDATE SET
+            service_count = ds.service_count + EXCLUDED.service_count,
+            total_cost = ds.total_cost + EXCLUDED.total_cost,
+            last_service_date = GREATEST(ds.last_service_date, EXCLUDED.last_service_date);
+    END IF;
+
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS trg_device_stats_insert ON Service_History;
+CREATE TRIGGER trg_device_stats_insert AFTER INSERT ON Service_History
+    REFERENCING NEW TABLE AS new_rows
+    FOR EACH STATEMENT EXECUTE FUNCTION device_stats_refresh();
+
+DROP TRIGGER IF EXISTS trg_device_stats_update ON Service_History;
+CREATE TRIGGER trg_device_stats_update AFTER UPDATE ON Service_History
+    REFERENCING OLD TABLE AS old_rows NEW TABLE AS new_rows
+    FOR EACH STATEMENT EXECUTE FUNCTION device_stats_refresh();
+
+DROP TRIGGER IF EXISTS trg_device_stats_delete ON Service_History;
+CREATE TRIGGER trg_device_stats_delete AFTER DELETE ON Service_History
+    REFERENCING OLD TABLE AS old_rows
+    FOR EACH STATEMENT EXECUTE FUNCTION device_stats_refresh();
+
+-- Пересчёт по всей истории: заполняет новую таблицу и исправляет расхождения в существующей
+DELETE FROM Device_Stats;
+INSERT INTO Device_Stats (device_id, service_count, total_cost, last_service_date)
+SELECT device_id, COUNT(*), COALESCE(SUM(cost), 0), MAX(service_date)
+FROM Service_History
+WHERE device_id IS NOT NULL
+GROUP BY device_id;
+)sql"},
+        {6, "service_history_notify",
+         // Лента изменений для колоночной копии /api/analytics (LISTEN service_history_changes).
+         // Даты — дни от 1970-01-01, стоимость — в копейках. Крупные операторы присылают только
+         // команду перезагрузки, чтобы не упираться в лимит размера payload у NOTIFY
+         R"sql(
+CREATE OR REPLACE FUNCTION service_history_notify() RETURNS TRIGGER AS $$
+DECLARE
+    changed INT;
+    payload JSON;
+BEGIN
+    IF TG_OP = 'DELETE' THEN
+        SELECT COUNT(*), json_agg(record_id) INTO changed, payload FROM old_rows;
+        IF changed > 100 THEN
+            PERFORM pg_notify('service_history_changes', '{"op":"reload"}');
+        ELSIF changed > 0 THEN
+            PERFORM pg_notify('service_history_changes',
+                json_build_object('op', 'delete', 'ids', payload)::text);
+        END IF;
+        RETURN NULL;
+    END IF;
+
+    IF TG_OP = 'UPDATE' THEN
+        SELECT json_agg(record_id) INTO payload FROM old_rows
+        WHERE record_id NOT IN (SELECT record_id FROM new_rows);
+        IF payload IS NOT NULL THEN
+            PERFORM pg_notify('service_history_changes',
+                json_build_object('op', 'delete', 'ids', payload)::text);
+        END IF;
+    END IF;
+
+    SELECT COUNT(*), json_agg(json_build_array(
+               record_id, device_id, service_id,
+               service_date - DATE '1970-01-01',
+               ROUND(cost * 100)::BIGINT,
+               next_due_date - DATE '1970-01-01'))
+    INTO changed, payload FROM new_rows;
+    IF changed > 100 THEN
+        PERFORM pg_notify('service_history_changes', '{"op":"reload"}');
+    ELSIF changed > 0 THEN
+        PERFORM pg_notify('service_history_changes',
+            json_build_object('op', 'upsert', 'rows', payload)::text);
+    END IF;
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS trg_service_history_notify_insert ON Service_History;
+CREATE TRIGGER trg_service_history_notify_insert AFTER INSERT ON Service_History
+    REFERENCING NEW TABLE AS new_rows
+    FOR EACH STATEMENT EXECUTE FUNCTION service_history_notify();
+
+DROP TRIGGER IF EXISTS trg_service_history_notify_update ON Service_History;
+CREATE TRIGGER trg_service_history_notify_update AFTER UPDATE ON Service_History
+    REFERENCING OLD TABLE AS old_rows NEW TABLE AS new_rows
+    FOR EACH STATEMENT EXECUTE FUNCTION service_history_notify();
+
+DROP TRIGGER IF EXISTS trg_service_history_notify_delete ON Service_History;
+CREATE TRIGGER trg_service_history_notify_delete AFTER DELETE ON Service_History
+    REFERENCING OLD TABLE AS old_rows
+    FOR EACH STATEMENT EXECUTE FUNCTION service_history_notify();
+)sql"},
+    };
+    
+    int currentVersion(pqxx::transaction_base& txn) {
+        return txn.query_value<int>("SELECT COALESCE(MAX(version), 0) FROM schema_migrations");
+    }
+}
+
+const std::vector<Migration>& all() {
+    return MIGRATIONS;
+}
+
+int run(pqxx::connection& conn) {
+    {
+        pqxx::work txn(conn);
+        txn.exec_params("SELECT pg_advisory_xact_lock($1)", MIGRATION_LOCK_KEY);
+        txn.exec(CREATE_TABLE_SQL);
+        txn.commit();
+    }
+    
+    int version = 0;
+    for (const auto& migration : MIGRATIONS) {
+        pqxx::work txn(conn);
+        txn.exec_params("SELECT pg_advisory_xact_lock($1)", MIGRATION_LOCK_KEY);
+        
+        // Версия перечитывается под блокировкой: её мог поднять другой экземпляр
+        version = currentVersion(txn);
+        if (migration.version <= version) {
+            continue;
+        }
+        
+        std::cout << "Applying schema migration " << migration.version << " (" << migration.name << ")"
+                  << std::endl;
+        txn.exec(migration.sql);
+        txn.exec_params("INSERT INTO schema_migrations (version, name) VALUES ($1, $2)",
+                        migration.version, migration.name);
+        txn.commit();
+        version = migration.version;
+    }
+    return version;
+}
+
+}
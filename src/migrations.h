@@ -0,0 +1,22 @@
+#pragma once
+#include <pqxx/pqxx>
+#include <vector>
+
+// Версионированные миграции схемы, применяемые при старте сервера.
+// create_db.sql создаёт новую базу в актуальном виде; миграции доводят до него
+// базы, созданные раньше (индексы и расширения выходят вместе с бинарником).
+// Применённые версии записываются в таблицу schema_migrations.
+namespace migrations {
+    struct Migration {
+        int version;
+        const char* name;
+        const char* sql;
+    };
+    
+    // Все миграции по возрастанию версии; новые добавляются только в конец
+    const std::vector<Migration>& all();
+    
+    // Применяет недостающие миграции, каждую в своей транзакции.
+    // Возвращает версию схемы после применения; при ошибке — std::runtime_error
+    int run(pqxx::connection& conn);
+}
@@ -0,0 +1,206 @@
+#pragma once
+#include <pqxx/pqxx>
+#include <nlohmann/json.hpp>
+#include <cmath>
+#include <compare>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Денежная сумма с фиксированной точкой: целое число копеек (int64).
+// Соответствует DECIMAL(10,2)/DECIMAL(12,2) без погрешностей double:
+// суммы и сравнения выполняются целочисленно.
+class Money {
+public:
+    // parse принимает до 16 цифр целой части. format выводит любое значение int64:
+    // знак, до 17 цифр целой части, точка, 2 цифры
+    static constexpr size_t MAX_TEXT_SIZE = 21;
+
+    // Граница сумм во входном JSON (по модулю, в рублях): как у parse
+    static constexpr int64_t MAX_UNITS = 10'000'000'000'000'000;
+
+    constexpr Money() = default;
+
+    static constexpr Money fromCents(int64_t cents) {
+        Money money;
+        money.cents_ = cents;
+        return money;
+    }
+
+    // Округление до копейки (половина — от нуля)
+    static Money fromDouble(double value) {
+        return fromCents(static_cast<int64_t>(std::llround(value * 100.0)));
+    }
+
+    constexpr int64_t cents() const { return cents_; }
+    constexpr double toDouble() const { return static_cast<double>(cents_) / 100.0; }
+
+    // Десятичная запись "-123.45" (как numeric в PostgreSQL). Цифры после второй
+    // дробной округляются по третьей (половина — от нуля)
+    static constexpr std::optional<Money> parse(std::string_view text) {
+        size_t i = 0;
+        bool negative = false;
+        if (i < text.size() && (text[i] == '-' || text[i] == '+')) {
+            negative = text[i] == '-';
+            ++i;
+        }
+
+        int64_t units = 0;
+        size_t int_digits = 0;
+        for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i, ++int_digits) {
+            if (int_digits >= 16) {
+                return std::nullopt;
+            }
+            units = units * 10 + (text[i] - '0');
+        }
+
+        int64_t fraction = 0;
+        size_t frac_digits = 0;
+        bool round_up = false;
+        if (i < text.size() && text[i] == '.') {
+            for (++i; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i, ++frac_digits) {
+                if (frac_digits < 2) {
+                    fraction = fraction * 10 + (text[i] - '0');
+                } else if (frac_digits == 2) {
+                    round_up = text[i] >= '5';
+                }
+            }
+        }
+
+        if (i != text.size() || int_digits + frac_digits == 0) {
+            return std::nullopt;
+        }
+        for (; frac_digits < 2; ++frac_digits) {
+            fraction *= 10;
+        }
+
+        int64_t cents = units * 100 + fraction + (round_up ? 1 : 0);
+        return fromCents(negative ? -cents : cents);
+    }
+
+    // Записывает текст без завершающего нуля, возвращает указатель за последним символом
+    constexpr char* format(char* out) const {
+        uint64_t magnitude = cents_ < 0 ? 0 - static_cast<uint64_t>(cents_) : static_cast<uint64_t>(cents_);
+        if (cents_ < 0) {
+            *out++ = '-';
+        }
+
+        char digits[20];
+        size_t count = 0;
+        uint64_t units = magnitude / 100;
+        do {
+            digits[count++] = static_cast<char>('0' + units % 10);
+            units /= 10;
+        } while (units > 0);
+        while (count > 0) {
+            *out++ = digits[--count];
+        }
+
+        *out++ = '.';
+        *out++ = static_cast<char>('0' + magnitude % 100 / 10);
+        *out++ = static_cast<char>('0' + magnitude % 10);
+        return out;
+    }
+
+    std::string toString() const {
+        char buffer[MAX_TEXT_SIZE];
+        return std::string(buffer, format(buffer));
+    }
+
+    constexpr Money& operator+=(Money other) {
+        cents_ += other.cents_;
+        return *this;
+    }
+    constexpr Money& operator-=(Money other) {
+        cents_ -= other.cents_;
+        return *this;
+    }
+    friend constexpr Money operator+(Money a, Money b) { return a += b; }
+    friend constexpr Money operator-(Money a, Money b) { return a -= b; }
+
+    friend constexpr auto operator<=>(const Money&, const Money&) = default;
+
+private:
+    int64_t cents_ = 0;
+};
+
+// JSON: число (123.45); на входе — число или строка "123.45".
+// nlohmann выводит double кратчайшей записью, которая читается обратно в то же значение,
+// поэтому суммы до 15 значащих цифр (DBL_DIG; DECIMAL(12,2) — 12) выводятся точно, как в БД.
+// JsonWriter выводит Money его собственной десятичной записью
+inline void to_json(nlohmann::json& j, const Money& money) {
+    j = money.toDouble();
+}
+
+inline void from_json(const nlohmann::json& j, Money& money) {
+    if (j.is_string()) {
+        auto parsed = Money::parse(j.get_ref<const std::string&>());
+        if (!parsed) {
+            throw std::invalid_argument("Invalid amount: '" + j.get<std::string>() + "'");
+        }
+        money = *parsed;
+        return;
+    }
+    // Граница проверяется до умножения на 100: иначе переполнение int64
+    if (j.is_number_unsigned()) {
+        uint64_t units = j.get<uint64_t>();
+        if (units >= static_cast<uint64_t>(Money::MAX_UNITS)) {
+            throw std::invalid_argument("Amount out of range");
+        }
+        money = Money::fromCents(static_cast<int64_t>(units) * 100);
+        return;
+    }
+    if (j.is_number_integer()) {
+        int64_t units = j.get<int64_t>();
+        if (units >= Money::MAX_UNITS || units <= -Money::MAX_UNITS) {
+            throw std::invalid_argument("Amount out of range");
+        }
+        money = Money::fromCents(units * 100);
+        return;
+    }
+    double value = j.get<double>();
+    if (!std::isfinite(value) || std::fabs(value) >= static_cast<double>(Money::MAX_UNITS)) {
+        throw std::invalid_argument("Amount out of range");
+    }
+    money = Money::fromDouble(value);
+}
+
+// Преобразование Money <-> текстовое представление numeric PostgreSQL.
+// NULL у Money нет: для nullable столбцов используется as<Money>(Money())
+namespace pqxx {
+    template<> struct nullness<Money> : no_null<Money> {};
+
+    template<> struct string_traits<Money> {
+        static constexpr bool converts_to_string = true;
+        static constexpr bool converts_from_string = true;
+
+        static Money from_string(std::string_view text) {
+            auto parsed = Money::parse(text);
+            if (!parsed) {
+                throw conversion_error("Could not convert '" + std::string(text) + "' to Money");
+            }
+            return *parsed;
+        }
+
+        static char* into_buf(char* begin, char* end, const Money& money) {
+            if (end - begin < static_cast<std::ptrdiff_t>(Money::MAX_TEXT_SIZE + 1)) {
+                throw conversion_overrun("Not enough buffer space for Money");
+            }
+            char* next = money.format(begin);
+            *next++ = '\0';
+            return next;
+        }
+
+        static zview to_buf(char* begin, char* end, const Money& money) {
+            char* next = into_buf(begin, end, money);
+            return zview{begin, static_cast<std::size_t>(next - begin - 1)};
+        }
+
+        static constexpr std::size_t size_buffer(const Money&) noexcept { return Money::MAX_TEXT_SIZE + 1; }
+    };
+
+    template<> inline const std::string type_name<Money>{"Money"};
+}
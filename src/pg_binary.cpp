@@ -0,0 +1,337 @@
+#include "pg_binary.h"
+#include <poll.h>
+#include <cerrno>
+#include <stdexcept>
+
+namespace pg_binary {
+
+namespace {
+    // Дни между 1970-01-01 и 2000-01-01 (эпоха дат PostgreSQL)
+    const int32_t POSTGRES_EPOCH_DAYS = 10957;
+
+    const uint16_t NUMERIC_NEG = 0x4000;
+    const uint16_t NUMERIC_POS = 0x0000;
+
+    uint16_t readUint16(const char* data) {
+        const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+        return static_cast<uint16_t>((bytes[0] << 8) | bytes[1]);
+    }
+
+    uint32_t readUint32(const char* data) {
+        const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+        return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) |
+               (static_cast<uint32_t>(bytes[2]) << 8) | static_cast<uint32_t>(bytes[3]);
+    }
+
+    void expectLength(int length, int expected, const char* type) {
+        if (length != expected) {
+            throw std::runtime_error(std::string("Unexpected binary length for ") + type);
+        }
+    }
+}
+
+int32_t decodeInt4(const char* data, int length) {
+    expectLength(length, 4, "int4");
+    return static_cast<int32_t>(readUint32(data));
+}
+
+int64_t decodeInt8(const char* data, int length) {
+    expectLength(length, 8, "int8");
+    uint64_t high = readUint32(data);
+    return static_cast<int64_t>((high << 32) | readUint32(data + 4));
+}
+
+Date decodeDate(const char* data, int length) {
+    expectLength(length, 4, "date");
+    int32_t days = static_cast<int32_t>(readUint32(data));
+    // -infinity/infinity
+    if (days == std::numeric_limits<int32_t>::min() || days == std::numeric_limits<int32_t>::max()) {
+        throw std::runtime_error("Infinite dates are not supported");
+    }
+    return Date::fromDays(days + POSTGRES_EPOCH_DAYS);
+}
+
+// Формат numeric: ndigits, weight, sign, dscale (int16), затем ndigits цифр по основанию 10000;
+// значение = sum(digit[i] * 10000^(weight - i))
+Money decodeNumeric(const char* data, int length) {
+    if (length < 8) {
+        throw std::runtime_error("Unexpected binary length for numeric");
+    }
+    int ndigits = readUint16(data);
+    int weight = static_cast<int16_t>(readUint16(data + 2));
+    uint16_t sign = readUint16(data + 4);
+    if (length != 8 + ndigits * 2) {
+        throw std::runtime_error("Unexpected binary length for numeric");
+    }
+    if (sign != NUMERIC_POS && sign != NUMERIC_NEG) {
+        throw std::runtime_error("NaN and infinite numerics are not supported");
+    }
+    // 10000^4 * 100 копеек помещается в int64, больше — нет
+    if (weight > 3) {
+        throw std::runtime_error("numeric value out of range for Money");
+    }
+
+    auto digit = [&](int index) -> int64_t {
+        return index >= 0 && index < ndigits ? readUint16(data + 8 + index * 2) : 0;
+    };
+
+    int64_t units = 0;
+    for (int exponent = weight; exponent >= 0; --exponent) {
+        units = units * 10000 + digit(weight - exponent);
+    }
+
+    // Первая дробная цифра по основанию 10000 — четыре десятичных знака:
+    // два дают копейки, третий — округление (половина — от нуля, как Money::parse)
+    int64_t fraction = digit(weight + 1);
+    int64_t cents = units * 100 + fraction / 100 + (fraction % 100 >= 50 ? 1 : 0);
+    return Money::fromCents(sign == NUMERIC_NEG ? -cents : cents);
+}
+
+void Result::expectTypes(std::initializer_list<Oid> types) const {
+    if (columns() != static_cast<int>(types.size())) {
+        throw std::runtime_error("Unexpected number of columns in binary result");
+    }
+
+    int column = 0;
+    for (Oid expected : types) {
+        Oid actual = PQftype(result.get(), column);
+        bool text_like = expected == TEXT_OID &&
+                         (actual == TEXT_OID || actual == VARCHAR_OID || actual == BPCHAR_OID);
+        if (actual != expected && !text_like) {
+            throw std::runtime_error("Unexpected type of column " + std::string(PQfname(result.get(), column)) +
+                                     " (oid " + std::to_string(actual) + ")");
+        }
+        ++column;
+    }
+}
+
+namespace {
+    // Ошибка сервера или соединения с кодом SQLSTATE; result освобождается
+    [[noreturn]] void throwError(PGconn* conn, PGresult* result, const char* prefix) {
+        std::string error = result ? PQresultErrorMessage(result) : PQerrorMessage(conn);
+        const char* sqlstate = result ? PQresultErrorField(result, PG_DIAG_SQLSTATE) : nullptr;
+        Error failure(prefix + error, sqlstate ? sqlstate : "");
+        PQclear(result);
+        throw failure;
+    }
+}
+
+Result Connection::exec(const std::string& query, const std::vector<std::string>& params) {
+    std::vector<const char*> values;
+    values.reserve(params.size());
+    for (const auto& param : params) {
+        values.push_back(param.c_str());
+    }
+
+    PGresult* result = PQexecParams(conn, query.c_str(), static_cast<int>(values.size()), nullptr,
+                                    values.data(), nullptr, nullptr, 1);
+    if (!result || PQresultStatus(result) != PGRES_TUPLES_OK) {
+        throwError(conn, result, "Binary query failed: ");
+    }
+    return Result(result);
+}
+
+void Connection::command(const std::string& query) {
+    PGresult* result = PQexec(conn, query.c_str());
+    if (!result || PQresultStatus(result) != PGRES_COMMAND_OK) {
+        throwError(conn, result, "Binary connection command failed: ");
+    }
+    PQclear(result);
+}
+
+ReadOnlyTransaction::ReadOnlyTransaction(Connection& conn) : conn(conn) {
+    conn.command("BEGIN READ ONLY");
+}
+
+ReadOnlyTransaction::~ReadOnlyTransaction() {
+    if (!open) {
+        return;
+    }
+    try {
+        conn.command("ROLLBACK");
+    } catch (const std::exception&) {
+        // Соединение разорвано: откатывать нечего
+    }
+}
+
+void ReadOnlyTransaction::setStatementTimeout(std::chrono::milliseconds timeout) {
+    conn.command("SET LOCAL statement_timeout = " + std::to_string(timeout.count()));
+}
+
+void ReadOnlyTransaction::commit() {
+    open = false;
+    conn.command("COMMIT");
+}
+
+namespace {
+    // Ответы пакета по порядку отправки: номер сегмента и номер запроса в нём
+    // (SERVICE_COMMAND — BEGIN/SET/COMMIT/ROLLBACK сегмента, SYNC — точка PQpipelineSync)
+    const int SERVICE_COMMAND = -1;
+    const int SYNC = -2;
+
+    struct PipelineReply {
+        size_t segment;
+        int query;
+    };
+
+    // Ожидание сокета соединения: чтение всегда, запись — пока libpq не отправил весь буфер
+    void waitForSocket(PGconn* conn, bool write) {
+        pollfd fd{};
+        fd.fd = PQsocket(conn);
+        fd.events = static_cast<short>(POLLIN | (write ? POLLOUT : 0));
+        if (poll(&fd, 1, -1) < 0 && errno != EINTR) {
+            throw Error("Pipeline poll failed", "");
+        }
+    }
+
+    // Возврат соединения в обычный режим на любом пути выхода из runPipeline. Транзакция
+    // последнего сегмента, прерванного ошибкой, остаётся открытой (в состоянии ошибки) — откат
+    class PipelineModeGuard {
+    private:
+        PGconn* conn;
+
+    public:
+        explicit PipelineModeGuard(PGconn* conn) : conn(conn) {}
+
+        ~PipelineModeGuard() {
+            // Не выйдет, если ответы не дочитаны (разрыв соединения): сеанс уже непригоден
+            PQexitPipelineMode(conn);
+            PQsetnonblocking(conn, 0);
+            PGTransactionStatusType status = PQtransactionStatus(conn);
+            if (status == PQTRANS_INTRANS || status == PQTRANS_INERROR) {
+                PQclear(PQexec(conn, "ROLLBACK"));
+            }
+        }
+
+        PipelineModeGuard(const PipelineModeGuard&) = delete;
+        PipelineModeGuard& operator=(const PipelineModeGuard&) = delete;
+    };
+}
+
+std::vector<PipelineOutcome> runPipeline(PGconn* conn, const std::vector<const PipelineSegment*>& segments) {
+    std::vector<PipelineOutcome> outcomes(segments.size());
+    if (segments.empty()) {
+        return outcomes;
+    }
+
+    if (PQsetnonblocking(conn, 1) != 0) {
+        throwError(conn, nullptr, "Pipeline setup failed: ");
+    }
+    if (PQenterPipelineMode(conn) != 1) {
+        PQsetnonblocking(conn, 0);
+        throwError(conn, nullptr, "Pipeline setup failed: ");
+    }
+    PipelineModeGuard guard(conn);
+
+    std::vector<PipelineReply> replies;
+    auto send = [&](size_t segment, int query, const std::string& sql, const std::vector<std::string>& params,
+                    int result_format) {
+        std::vector<const char*> values;
+        values.reserve(params.size());
+        for (const auto& param : params) {
+            values.push_back(param.c_str());
+        }
+        if (!PQsendQueryParams(conn, sql.c_str(), static_cast<int>(values.size()), nullptr, values.data(),
+                               nullptr, nullptr, result_format)) {
+            throwError(conn, nullptr, "Pipeline send failed: ");
+        }
+        replies.push_back({segment, query});
+    };
+
+    // Сегмент: [ROLLBACK] BEGIN [set_config] запросы COMMIT, затем Sync. Ошибка внутри явной
+    // транзакции оставляет её открытой после Sync, и без ROLLBACK следующий сегмент был бы
+    // отменён вместе с ней; после успешного сегмента ROLLBACK даёт лишь предупреждение.
+    // SET LOCAL не принимает параметры, поэтому срок задаётся через set_config(..., true)
+    const std::vector<std::string> no_params;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        if (i > 0) {
+            send(i, SERVICE_COMMAND, "ROLLBACK", no_params, 0);
+        }
+        send(i, SERVICE_COMMAND, "BEGIN ISOLATION LEVEL REPEATABLE READ READ ONLY", no_params, 0);
+        if (segments[i]->statement_timeout) {
+            send(i, SERVICE_COMMAND, "SELECT set_config('statement_timeout', $1, true)",
+                 {std::to_string(segments[i]->statement_timeout->count())}, 0);
+        }
+        for (size_t q = 0; q < segments[i]->queries.size(); ++q) {
+            const PipelineQuery& query = segments[i]->queries[q];
+            send(i, static_cast<int>(q), query.sql, query.params, 1);
+        }
+        send(i, SERVICE_COMMAND, "COMMIT", no_params, 0);
+        if (PQpipelineSync(conn) != 1) {
+            throwError(conn, nullptr, "Pipeline sync failed: ");
+        }
+        replies.push_back({i, SYNC});
+    }
+
+    // Отправка и чтение идут вместе: при большом пакете сервер начинает отвечать раньше,
+    // чем libpq отправит весь буфер, и ни одна сторона не ждёт другую
+    size_t next = 0;
+    while (next < replies.size()) {
+        int pending_output = PQflush(conn);
+        if (pending_output < 0) {
+            throwError(conn, nullptr, "Pipeline flush failed: ");
+        }
+        if (PQisBusy(conn)) {
+            waitForSocket(conn, pending_output == 1);
+            if (!PQconsumeInput(conn)) {
+                throwError(conn, nullptr, "Pipeline read failed: ");
+            }
+            continue;
+        }
+
+        // NULL отделяет результаты одной команды от следующей
+        PGresult* result = PQgetResult(conn);
+        if (!result) {
+            continue;
+        }
+        const PipelineReply& reply = replies[next++];
+        PipelineOutcome& outcome = outcomes[reply.segment];
+        ExecStatusType status = PQresultStatus(result);
+
+        if (reply.query == SYNC) {
+            PQclear(result);
+            if (status != PGRES_PIPELINE_SYNC) {
+                throw Error("Unexpected reply in pipeline", "");
+            }
+            continue;
+        }
+        // Команды после ошибки до Sync не выполнялись; ошибка уже записана
+        if (status == PGRES_PIPELINE_ABORTED) {
+            PQclear(result);
+            continue;
+        }
+        if (status == PGRES_FATAL_ERROR) {
+            if (!outcome.error) {
+                try {
+                    throwError(conn, result, "Pipeline query failed: ");
+                } catch (const Error&) {
+                    outcome.error = std::current_exception();
+                }
+            } else {
+                PQclear(result);
+            }
+            continue;
+        }
+        if (reply.query == SERVICE_COMMAND) {
+            PQclear(result);
+            continue;
+        }
+        if (status != PGRES_TUPLES_OK) {
+            PQclear(result);
+            if (!outcome.error) {
+                outcome.error = std::make_exception_ptr(Error("Pipeline query returned no rows", ""));
+            }
+            continue;
+        }
+        outcome.results.emplace_back(result);
+    }
+
+    for (auto& outcome : outcomes) {
+        if (outcome.error) {
+            outcome.results.clear();
+        }
+    }
+    return outcomes;
+}
+
+}
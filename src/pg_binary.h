@@ -0,0 +1,162 @@
+#pragma once
+#include "date.h"
+#include "money.h"
+#include <libpq-fe.h>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <initializer_list>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Чтение результатов PostgreSQL в бинарном формате (libpq, resultFormat = 1):
+// int4, date и numeric декодируются из сетевого представления без разбора текста,
+// текстовые поля доступны как std::string_view в буфер PGresult без копирования.
+namespace pg_binary {
+
+    // OID типов PostgreSQL (pg_type.dat)
+    constexpr Oid INT8_OID = 20;
+    constexpr Oid INT4_OID = 23;
+    constexpr Oid TEXT_OID = 25;
+    constexpr Oid BPCHAR_OID = 1042;
+    constexpr Oid VARCHAR_OID = 1043;
+    constexpr Oid DATE_OID = 1082;
+    constexpr Oid NUMERIC_OID = 1700;
+
+    // Ошибка запроса; sqlstate() — код SQLSTATE сервера (пустой, если ответа не было)
+    class Error : public std::runtime_error {
+    private:
+        std::string state;
+
+    public:
+        Error(const std::string& message, std::string sqlstate)
+            : std::runtime_error(message), state(std::move(sqlstate)) {}
+
+        const std::string& sqlstate() const { return state; }
+    };
+
+    // Декодеры бинарного представления значения (big-endian)
+    int32_t decodeInt4(const char* data, int length);
+    int64_t decodeInt8(const char* data, int length);
+    Date decodeDate(const char* data, int length);
+    Money decodeNumeric(const char* data, int length);
+
+    class Result {
+    private:
+        std::unique_ptr<PGresult, void (*)(PGresult*)> result;
+
+    public:
+        explicit Result(PGresult* result) : result(result, PQclear) {}
+
+        int rows() const { return PQntuples(result.get()); }
+        int columns() const { return PQnfields(result.get()); }
+
+        // Проверка типов столбцов до декодирования; text допускает text/varchar/bpchar
+        void expectTypes(std::initializer_list<Oid> types) const;
+
+        bool isNull(int row, int column) const { return PQgetisnull(result.get(), row, column); }
+
+        int32_t int4(int row, int column) const {
+            return decodeInt4(PQgetvalue(result.get(), row, column), PQgetlength(result.get(), row, column));
+        }
+
+        int64_t int8(int row, int column) const {
+            return decodeInt8(PQgetvalue(result.get(), row, column), PQgetlength(result.get(), row, column));
+        }
+
+        // NULL -> Date()
+        Date date(int row, int column) const {
+            return isNull(row, column) ? Date()
+                                       : decodeDate(PQgetvalue(result.get(), row, column),
+                                                    PQgetlength(result.get(), row, column));
+        }
+
+        // NULL -> Money() (ноль), как as<Money>(Money()) в текстовом пути
+        Money numeric(int row, int column) const {
+            return isNull(row, column) ? Money()
+                                       : decodeNumeric(PQgetvalue(result.get(), row, column),
+                                                       PQgetlength(result.get(), row, column));
+        }
+
+        // Действительно, пока жив Result. NULL -> пустая строка (так PQgetvalue отдаёт NULL),
+        // как viewOrEmpty в текстовом пути: NULL и '' не различаются. Где разница важна,
+        // сначала проверяется isNull
+        std::string_view text(int row, int column) const {
+            return std::string_view(PQgetvalue(result.get(), row, column),
+                                    static_cast<size_t>(PQgetlength(result.get(), row, column)));
+        }
+    };
+
+    // Запросы libpq на PGconn соединения из пула Database (ConnectionLease::raw()).
+    // Соединением не владеет: оно закрывается вместе с pqxx::connection пула
+    class Connection {
+    private:
+        PGconn* conn;
+
+    public:
+        explicit Connection(PGconn* conn) : conn(conn) {}
+
+        // Запрос с бинарным результатом; параметры передаются текстом ($1, $2, ...).
+        // Ошибки — pg_binary::Error
+        Result exec(const std::string& query, const std::vector<std::string>& params = {});
+
+        // Команда без строк результата (BEGIN, SET, COMMIT)
+        void command(const std::string& query);
+    };
+
+    // Запрос пакета pipeline; параметры передаются текстом ($1, $2, ...), результат — бинарный
+    struct PipelineQuery {
+        std::string sql;
+        std::vector<std::string> params;
+    };
+
+    // Сегмент пакета: запросы одной транзакции REPEATABLE READ только для чтения (один снимок БД).
+    // statement_timeout — SET LOCAL внутри транзакции сегмента, как в ReadOnlyTransaction
+    struct PipelineSegment {
+        std::vector<PipelineQuery> queries;
+        std::optional<std::chrono::milliseconds> statement_timeout;
+    };
+
+    // Итог сегмента: результаты запросов по порядку или первая ошибка сегмента (pg_binary::Error)
+    struct PipelineOutcome {
+        std::vector<Result> results;
+        std::exception_ptr error;
+    };
+
+    // Выполнение сегментов в режиме pipeline libpq (PQenterPipelineMode, libpq 14+) на одном
+    // соединении: все сегменты отправляются без ожидания ответов (PQsendQueryParams,
+    // PQpipelineSync после каждого) и занимают один round trip. Ошибка сегмента не затрагивает
+    // остальные: его транзакция откатывается, следующие выполняются. Ошибка соединения —
+    // исключение pg_binary::Error для всего пакета. На время пакета соединение переводится
+    // в неблокирующий режим; по завершении режим pipeline выключается, транзакций не остаётся
+    std::vector<PipelineOutcome> runPipeline(PGconn* conn, const std::vector<const PipelineSegment*>& segments);
+
+    // Транзакция только для чтения: без commit() деструктор выполняет ROLLBACK,
+    // и соединение возвращается в пул без открытой транзакции
+    class ReadOnlyTransaction {
+    private:
+        Connection& conn;
+        bool open = true;
+
+    public:
+        explicit ReadOnlyTransaction(Connection& conn);
+        ~ReadOnlyTransaction();
+
+        ReadOnlyTransaction(const ReadOnlyTransaction&) = delete;
+        ReadOnlyTransaction& operator=(const ReadOnlyTransaction&) = delete;
+
+        // SET LOCAL statement_timeout: действует до конца транзакции
+        void setStatementTimeout(std::chrono::milliseconds timeout);
+
+        Result exec(const std::string& query, const std::vector<std::string>& params = {}) {
+            return conn.exec(query, params);
+        }
+
+        void commit();
+    };
+
+}
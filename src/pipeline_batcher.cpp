@@ -0,0 +1,110 @@
+#include "pipeline_batcher.h"
+#include "metrics.h"
+#include <stdexcept>
+
+PipelineBatcher::PipelineBatcher(Settings settings, Runner runner)
+    : settings(settings), runner(std::move(runner)) {
+    if (this->settings.max_batch == 0) {
+        this->settings.max_batch = 1;
+    }
+    worker = std::thread([this] { workerLoop(); });
+}
+
+PipelineBatcher::~PipelineBatcher() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        stopping = true;
+    }
+    queue_cv.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void PipelineBatcher::configure(Settings settings) {
+    if (settings.max_batch == 0) {
+        settings.max_batch = 1;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        this->settings = settings;
+    }
+    queue_cv.notify_all();
+}
+
+std::vector<pg_binary::Result> PipelineBatcher::execute(pg_binary::PipelineSegment segment) {
+    auto pending = std::make_unique<Pending>();
+    pending->segment = std::move(segment);
+    pending->enqueued_at = Clock::now();
+    auto future = pending->promise.get_future();
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        if (stopping) {
+            throw std::runtime_error("Pipeline batcher is stopped");
+        }
+        queue.push_back(std::move(pending));
+    }
+    queue_cv.notify_all();
+    return future.get();
+}
+
+void PipelineBatcher::workerLoop() {
+    while (true) {
+        std::vector<std::unique_ptr<Pending>> batch;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_cv.wait(lock, [this] { return stopping || !queue.empty(); });
+            
+            // Перед остановкой выполняем уже поставленные сегменты
+            if (stopping && queue.empty()) {
+                return;
+            }
+            
+            // Окно отсчитывается от самого старого сегмента: после долгого пакета
+            // накопившаяся очередь уходит сразу
+            queue_cv.wait_until(lock, queue.front()->enqueued_at + settings.window, [this] {
+                return stopping || queue.size() >= settings.max_batch;
+            });
+            
+            size_t count = std::min(queue.size(), settings.max_batch);
+            batch.reserve(count);
+            for (size_t i = 0; i < count; ++i) {
+                batch.push_back(std::move(queue.front()));
+                queue.pop_front();
+            }
+        }
+        runBatch(batch);
+    }
+}
+
+void PipelineBatcher::runBatch(std::vector<std::unique_ptr<Pending>>& batch) {
+    auto start_time = Clock::now();
+    std::vector<const pg_binary::PipelineSegment*> segments;
+    segments.reserve(batch.size());
+    for (const auto& pending : batch) {
+        segments.push_back(&pending->segment);
+    }
+    
+    try {
+        auto outcomes = runner(segments);
+        if (outcomes.size() != batch.size()) {
+            throw std::runtime_error("Pipeline returned " + std::to_string(outcomes.size()) + " outcomes for " +
+                                     std::to_string(batch.size()) + " segments");
+        }
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (outcomes[i].error) {
+                batch[i]->promise.set_exception(outcomes[i].error);
+            } else {
+                batch[i]->promise.set_value(std::move(outcomes[i].results));
+            }
+        }
+    } catch (...) {
+        // Ошибка соединения или пакета целиком: её получают все сегменты
+        for (auto& pending : batch) {
+            pending->promise.set_exception(std::current_exception());
+        }
+    }
+    
+    double duration = std::chrono::duration<double>(Clock::now() - start_time).count();
+    MetricsRegistry::getInstance().recordPipelineBatch(batch.size(), duration);
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "pg_binary.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Сбор сегментов pipeline (pg_binary::PipelineSegment) от одновременных HTTP-запросов
+// в общий пакет. Первый сегмент в очереди ждёт не дольше window, затем собранные сегменты
+// (не больше max_batch) уходят одним пакетом: одно соединение пула и один round trip
+// на всех. Пока пакет выполняется, следующие сегменты копятся в очереди.
+// Потоки DbExecutor блокируются в execute до результата своего сегмента
+class PipelineBatcher {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Settings {
+        std::chrono::microseconds window{2000};
+        size_t max_batch = 32;
+    };
+
+    // Выполнение пакета: итог на каждый сегмент по порядку (Database — runPipeline на
+    // соединении пула). Исключение означает ошибку всего пакета
+    using Runner = std::function<std::vector<pg_binary::PipelineOutcome>(
+        const std::vector<const pg_binary::PipelineSegment*>&)>;
+
+    PipelineBatcher(Settings settings, Runner runner);
+    ~PipelineBatcher();
+
+    PipelineBatcher(const PipelineBatcher&) = delete;
+    PipelineBatcher& operator=(const PipelineBatcher&) = delete;
+
+    void configure(Settings settings);
+
+    // Результаты запросов сегмента по порядку; ошибка сегмента или пакета — исключение
+    std::vector<pg_binary::Result> execute(pg_binary::PipelineSegment segment);
+
+private:
+    struct Pending {
+        pg_binary::PipelineSegment segment;
+        std::promise<std::vector<pg_binary::Result>> promise;
+        Clock::time_point enqueued_at;
+    };
+
+    Settings settings;
+    Runner runner;
+    std::deque<std::unique_ptr<Pending>> queue;
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    bool stopping = false;
+    std::thread worker;
+
+    void workerLoop();
+    void runBatch(std::vector<std::unique_ptr<Pending>>& batch);
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include "auth_middleware.h"
+#include "metrics.h"
+#include "rate_limiter.h"
+#include <crow.h>
+#include <nlohmann/json.hpp>
+#include <memory>
+#include <string>
+
+// Middleware Crow: ограничение частоты запросов по группам маршрутов (rate_limits в config.json).
+// Клиент — пользователь из проверенного токена (контекст AuthMiddleware, поэтому эта
+// middleware идёт в списке после неё) или IP-адрес. Превышение — 429 с Retry-After
+// до вызова обработчика и до обращения к БД.
+struct RateLimitMiddleware {
+    struct context {};
+
+    std::unique_ptr<RateLimiter> limiter;
+
+    void configure(std::unique_ptr<RateLimiter> rate_limiter) {
+        limiter = std::move(rate_limiter);
+    }
+
+    template<typename AllContext>
+    void before_handle(crow::request& req, crow::response& res, context&, AllContext& all_ctx) {
+        if (!limiter) {
+            return;
+        }
+        const RateLimiter::Group* group = limiter->match(req.url);
+        if (!group) {
+            return;
+        }
+
+        // Пользователь из неподтверждённого токена не учитывается: иначе подделанные
+        // токены позволили бы раскладывать запросы по новым корзинам
+        const auto& auth_ctx = all_ctx.template get<AuthMiddleware>();
+        bool by_token = auth_ctx.authenticated;
+        std::string client = by_token ? "user:" + auth_ctx.claims.username
+                                      : "ip:" + (req.remote_ip_address.empty() ? "unknown" : req.remote_ip_address);
+
+        auto retry_after = limiter->acquire(*group, client);
+        if (retry_after.count() == 0) {
+            return;
+        }
+
+        MetricsRegistry::getInstance().recordRateLimited(group->name, by_token ? "token" : "ip");
+
+        nlohmann::json response;
+        response["success"] = false;
+        response["error"] = "Too many requests";
+
+        res.code = 429;
+        res.set_header("Content-Type", "application/json; charset=utf-8");
+        res.set_header("Access-Control-Allow-Origin", "*");
+        res.set_header("Retry-After", std::to_string(retry_after.count()));
+        res.body = response.dump();
+        res.end();
+    }
+
+    void after_handle(crow::request&, crow::response&, context&) {}
+};
@@ -0,0 +1,77 @@
+#include "rate_limiter.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+RateLimiter::RateLimiter(std::vector<Group> groups, std::chrono::seconds sweep_interval)
+    : groups(std::move(groups)), sweep_interval(sweep_interval) {
+    for (const auto& group : this->groups) {
+        if (group.rate_per_second <= 0.0 || group.burst < 1.0) {
+            throw std::invalid_argument("Rate limit group " + group.name + " needs rate_per_second > 0 and burst >= 1");
+        }
+    }
+    sweeper = std::thread([this] { sweepLoop(); });
+}
+
+RateLimiter::~RateLimiter() {
+    {
+        std::lock_guard<std::mutex> lock(sweeper_mutex);
+        stopping = true;
+    }
+    sweeper_cv.notify_all();
+    if (sweeper.joinable()) {
+        sweeper.join();
+    }
+}
+
+const RateLimiter::Group* RateLimiter::match(const std::string& path) const {
+    for (const auto& group : groups) {
+        if (path.compare(0, group.prefix.size(), group.prefix) == 0) {
+            return &group;
+        }
+    }
+    return nullptr;
+}
+
+std::chrono::seconds RateLimiter::acquire(const Group& group, const std::string& client, Clock::time_point now) {
+    double wait_seconds = buckets.update(group.name + '|' + client, [&](Bucket& bucket) {
+        if (!bucket.initialized) {
+            bucket.tokens = group.burst;
+            bucket.updated = now;
+            bucket.initialized = true;
+        } else if (now > bucket.updated) {
+            double elapsed = std::chrono::duration<double>(now - bucket.updated).count();
+            bucket.tokens = std::min(group.burst, bucket.tokens + elapsed * group.rate_per_second);
+            bucket.updated = now;
+        }
+
+        double wait = 0.0;
+        if (bucket.tokens >= 1.0) {
+            bucket.tokens -= 1.0;
+        } else {
+            wait = (1.0 - bucket.tokens) / group.rate_per_second;
+        }
+
+        auto refill = std::chrono::duration<double>((group.burst - bucket.tokens) / group.rate_per_second);
+        bucket.full_at = now + std::chrono::duration_cast<Clock::duration>(refill);
+        return wait;
+    });
+
+    if (wait_seconds <= 0.0) {
+        return std::chrono::seconds(0);
+    }
+    return std::chrono::seconds(std::max<int64_t>(1, static_cast<int64_t>(std::ceil(wait_seconds))));
+}
+
+size_t RateLimiter::sweep(Clock::time_point now) {
+    return buckets.eraseIf([now](const Bucket& bucket) { return bucket.full_at <= now; });
+}
+
+void RateLimiter::sweepLoop() {
+    std::unique_lock<std::mutex> lock(sweeper_mutex);
+    while (!sweeper_cv.wait_for(lock, sweep_interval, [this] { return stopping; })) {
+        lock.unlock();
+        sweep();
+        lock.lock();
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "sharded_map.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Ограничение частоты запросов: корзина жетонов на клиента (IP или пользователь
+// из токена) в каждой группе маршрутов. Пополнение ленивое — при обращении
+// к корзине по прошедшему времени, без таймеров. Корзины, успевшие наполниться
+// до предела, неотличимы от новых и удаляются фоновым потоком.
+class RateLimiter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Группа маршрутов: пути с префиксом prefix; burst — ёмкость корзины,
+    // rate_per_second — скорость пополнения
+    struct Group {
+        std::string name;
+        std::string prefix;
+        double rate_per_second = 10.0;
+        double burst = 20.0;
+    };
+
+    struct Bucket {
+        double tokens = 0.0;
+        Clock::time_point updated;
+        Clock::time_point full_at;  // момент, когда корзина наполнится без новых запросов
+        bool initialized = false;
+    };
+
+    explicit RateLimiter(std::vector<Group> groups,
+                         std::chrono::seconds sweep_interval = std::chrono::seconds(60));
+    ~RateLimiter();
+
+    RateLimiter(const RateLimiter&) = delete;
+    RateLimiter& operator=(const RateLimiter&) = delete;
+
+    // Первая группа, префикс которой совпадает с путём; nullptr — путь не ограничен
+    const Group* match(const std::string& path) const;
+
+    // Списание жетона; 0 — запрос разрешён, иначе — через сколько секунд повторить
+    std::chrono::seconds acquire(const Group& group, const std::string& client,
+                                 Clock::time_point now = Clock::now());
+
+    size_t sweep(Clock::time_point now = Clock::now());
+    size_t trackedBuckets() { return buckets.size(); }
+
+private:
+    std::vector<Group> groups;
+    ShardedMap<Bucket, 32> buckets;
+
+    std::chrono::seconds sweep_interval;
+    std::thread sweeper;
+    std::mutex sweeper_mutex;
+    std::condition_variable sweeper_cv;
+    bool stopping = false;
+
+    void sweepLoop();
+};
@@ -0,0 +1,74 @@
+#include "request_arena.h"
+#include "metrics.h"
+#include <memory>
+
+namespace {
+    // Считает выделения и байты, переданные ресурсу upstream
+    class CountingResource : public std::pmr::memory_resource {
+    private:
+        std::pmr::memory_resource* upstream;
+
+    public:
+        size_t allocations = 0;
+        size_t bytes = 0;
+
+        explicit CountingResource(std::pmr::memory_resource* upstream) : upstream(upstream) {}
+
+    private:
+        void* do_allocate(size_t size, size_t alignment) override {
+            ++allocations;
+            bytes += size;
+            return upstream->allocate(size, alignment);
+        }
+
+        void do_deallocate(void* p, size_t size, size_t alignment) override {
+            upstream->deallocate(p, size, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    // counting — выделения запроса; overflow — блоки, которые арена взяла из кучи,
+    // когда начальный буфер закончился
+    struct ThreadArena {
+        std::unique_ptr<std::byte[]> buffer{new std::byte[RequestArena::INITIAL_SIZE]};
+        CountingResource overflow{std::pmr::new_delete_resource()};
+        std::pmr::monotonic_buffer_resource arena{buffer.get(), RequestArena::INITIAL_SIZE, &overflow};
+        CountingResource counting{&arena};
+        int depth = 0;
+    };
+
+    ThreadArena& threadArena() {
+        thread_local ThreadArena instance;
+        return instance;
+    }
+}
+
+RequestArena::Scope::Scope() {
+    ++threadArena().depth;
+}
+
+RequestArena::Scope::~Scope() {
+    ThreadArena& state = threadArena();
+    // Вложенный Scope не сбрасывает арену внешнего
+    if (--state.depth > 0) {
+        return;
+    }
+
+    if (state.counting.allocations > 0) {
+        MetricsRegistry::getInstance().recordArenaUsage(state.counting.allocations, state.counting.bytes,
+                                                        state.overflow.allocations > 0);
+    }
+    state.counting.allocations = 0;
+    state.counting.bytes = 0;
+    state.overflow.allocations = 0;
+    state.overflow.bytes = 0;
+    state.arena.release();
+}
+
+std::pmr::memory_resource* RequestArena::resource() {
+    ThreadArena& state = threadArena();
+    return state.depth > 0 ? &state.counting : std::pmr::get_default_resource();
+}
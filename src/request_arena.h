@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <memory_resource>
+
+// Арена временных объектов запроса: std::pmr::monotonic_buffer_resource поверх
+// буфера, закреплённого за потоком DbExecutor. Выделения внутри запроса — сдвиг
+// указателя без обращения к malloc; вся память освобождается разом в конце запроса
+// (RequestArena::Scope), и буфер переиспользуется следующим запросом этого потока.
+// Из арены берутся представления строк результата и тело JSON (JsonWriter);
+// объекты из арены не должны переживать Scope, поэтому готовое тело копируется
+// в crow::response одним выделением точного размера (responseBody)
+class RequestArena {
+public:
+    // Начальный буфер потока; при переполнении арена берёт блоки из кучи до конца запроса
+    static constexpr size_t INITIAL_SIZE = 256 * 1024;
+
+    // Границы запроса: открывается в dispatchTo на время обработчика.
+    // При закрытии пишет метрики арены и сбрасывает её
+    class Scope {
+    public:
+        Scope();
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    // Арена текущего запроса; вне Scope — ресурс по умолчанию (куча)
+    static std::pmr::memory_resource* resource();
+};
@@ -0,0 +1,36 @@
+#include "request_deadline.h"
+#include <algorithm>
+
+namespace {
+    thread_local std::optional<RequestDeadline::Clock::time_point> thread_deadline;
+}
+
+RequestDeadline::Scope::Scope(std::optional<Clock::time_point> deadline) : previous(thread_deadline) {
+    thread_deadline = deadline;
+}
+
+RequestDeadline::Scope::~Scope() {
+    thread_deadline = previous;
+}
+
+std::optional<RequestDeadline::Clock::time_point> RequestDeadline::current() {
+    return thread_deadline;
+}
+
+std::optional<std::chrono::milliseconds> RequestDeadline::remaining(Clock::time_point now) {
+    if (!thread_deadline) {
+        return std::nullopt;
+    }
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(*thread_deadline - now);
+    return std::max(left, std::chrono::milliseconds(1));
+}
+
+bool RequestDeadline::expired(Clock::time_point now) {
+    return thread_deadline && now >= *thread_deadline;
+}
+
+void RequestDeadline::check(const char* stage) {
+    if (expired()) {
+        throw DeadlineExceeded(stage);
+    }
+}
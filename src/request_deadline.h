@@ -0,0 +1,43 @@
+#pragma once
+#include <chrono>
+#include <optional>
+#include <stdexcept>
+
+// Срок выполнения текущего запроса, закреплённый за потоком DbExecutor на время
+// обработчика (RequestDeadline::Scope открывается в dispatchDb). Database переводит
+// оставшееся время в SET LOCAL statement_timeout каждой транзакции, обработчики
+// проверяют срок перед дорогой сериализацией ответа. Истёкший срок — ответ 504.
+class RequestDeadline {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Границы запроса; без значения — запрос без срока. Вложенные Scope восстанавливают внешний срок
+    class Scope {
+    private:
+        std::optional<Clock::time_point> previous;
+
+    public:
+        explicit Scope(std::optional<Clock::time_point> deadline);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    static std::optional<Clock::time_point> current();
+
+    // Оставшееся время (не меньше 1 мс: statement_timeout = 0 отключает ограничение);
+    // nullopt — у запроса нет срока
+    static std::optional<std::chrono::milliseconds> remaining(Clock::time_point now = Clock::now());
+
+    static bool expired(Clock::time_point now = Clock::now());
+
+    // DeadlineExceeded(stage), если срок истёк
+    static void check(const char* stage);
+};
+
+// Срок запроса истёк; what() — этап, на котором это обнаружено
+class DeadlineExceeded : public std::runtime_error {
+public:
+    explicit DeadlineExceeded(const char* stage) : std::runtime_error(stage) {}
+};
@@ -0,0 +1,73 @@
+#include "service_export.h"
+#include "json_writer.h"
+
+namespace service_export {
+
+namespace {
+    const char* const COLUMN_NAMES[] = {
+        "record_id", "device_id", "service_id", "service_date", "cost", "notes", "next_due_date"
+    };
+    const size_t COLUMN_COUNT = sizeof(COLUMN_NAMES) / sizeof(COLUMN_NAMES[0]);
+    
+    // Числовые колонки выводятся в NDJSON без кавычек
+    bool isNumericColumn(size_t index) {
+        return index <= 2 || index == 4;
+    }
+    
+    void appendCsvField(std::string& out, pqxx::zview field) {
+        if (field.data() == nullptr) {
+            return;
+        }
+        bool needs_quotes = field.find_first_of(",\"\r\n") != std::string_view::npos;
+        if (!needs_quotes) {
+            out.append(field.data(), field.size());
+            return;
+        }
+        out += '"';
+        for (char c : field) {
+            if (c == '"') {
+                out += '"';
+            }
+            out += c;
+        }
+        out += '"';
+    }
+}
+
+void appendCsvHeader(std::string& out) {
+    for (size_t i = 0; i < COLUMN_COUNT; ++i) {
+        if (i > 0) out += ',';
+        out += COLUMN_NAMES[i];
+    }
+    out += '\n';
+}
+
+void appendCsvRow(std::string& out, const std::vector<pqxx::zview>& fields) {
+    for (size_t i = 0; i < fields.size(); ++i) {
+        if (i > 0) out += ',';
+        appendCsvField(out, fields[i]);
+    }
+    out += '\n';
+}
+
+void appendNdjsonRow(std::string& out, const std::vector<pqxx::zview>& fields) {
+    out += '{';
+    for (size_t i = 0; i < fields.size() && i < COLUMN_COUNT; ++i) {
+        if (i > 0) out += ',';
+        out += '"';
+        out += COLUMN_NAMES[i];
+        out += "\":";
+        
+        const pqxx::zview& field = fields[i];
+        if (field.data() == nullptr) {
+            out += "null";
+        } else if (isNumericColumn(i)) {
+            out.append(field.data(), field.size());
+        } else {
+            JsonWriter::appendString(out, field);
+        }
+    }
+    out += "}\n";
+}
+
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include <pqxx/pqxx>
+#include <string>
+#include <vector>
+
+// Форматирование строк COPY ... TO STDOUT для выгрузки истории обслуживания.
+// Поля пишутся сразу в выходной буфер, без промежуточных ServiceRecord/json.
+// Порядок полей: record_id, device_id, service_id, service_date, cost, notes, next_due_date
+namespace service_export {
+    void appendCsvHeader(std::string& out);
+    void appendCsvRow(std::string& out, const std::vector<pqxx::zview>& fields);
+    void appendNdjsonRow(std::string& out, const std::vector<pqxx::zview>& fields);
+}
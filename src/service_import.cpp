@@ -0,0 +1,190 @@
+#include "service_import.h"
+#include <charconv>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace service_import {
+
+namespace {
+    // Общая проверка значений строки, не требующая обращения к БД
+    void validateRecord(const ServiceRecord& record) {
+        if (record.device_id <= 0) {
+            throw std::invalid_argument("device_id must be positive");
+        }
+        if (record.service_id <= 0) {
+            throw std::invalid_argument("service_id must be positive");
+        }
+        if (record.service_date.isNull()) {
+            throw std::invalid_argument("service_date is required");
+        }
+        // DECIMAL(10,2)
+        if (record.cost < Money() || record.cost >= Money::fromCents(10000000000LL)) {
+            throw std::invalid_argument("cost out of range");
+        }
+    }
+    
+    int parseInt(const std::string& value, const char* field) {
+        int result = 0;
+        auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), result);
+        if (ec != std::errc() || ptr != value.data() + value.size()) {
+            throw std::invalid_argument(std::string("Invalid ") + field + ": '" + value + "'");
+        }
+        return result;
+    }
+    
+    // Пустое значение — NULL (Date())
+    Date parseDate(const std::string& value, const char* field) {
+        if (value.empty()) {
+            return Date();
+        }
+        auto date = Date::parse(value);
+        if (!date) {
+            throw std::invalid_argument(std::string("Invalid ") + field + ": '" + value + "'");
+        }
+        return *date;
+    }
+    
+    Money parseMoney(const std::string& value, const char* field) {
+        auto money = Money::parse(value);
+        if (!money) {
+            throw std::invalid_argument(std::string("Invalid ") + field + ": '" + value + "'");
+        }
+        return *money;
+    }
+    
+    // Разбор одной строки CSV с поддержкой кавычек ("" внутри кавычек — экранированная кавычка)
+    std::vector<std::string> splitCsvLine(const std::string& line) {
+        std::vector<std::string> fields;
+        std::string field;
+        bool quoted = false;
+        
+        for (size_t i = 0; i < line.size(); ++i) {
+            char c = line[i];
+            if (quoted) {
+                if (c == '"') {
+                    if (i + 1 < line.size() && line[i + 1] == '"') {
+                        field += '"';
+                        ++i;
+                    } else {
+                        quoted = false;
+                    }
+                } else {
+                    field += c;
+                }
+            } else if (c == '"') {
+                quoted = true;
+            } else if (c == ',') {
+                fields.push_back(std::move(field));
+                field.clear();
+            } else {
+                field += c;
+            }
+        }
+        if (quoted) {
+            throw std::invalid_argument("Unterminated quoted field");
+        }
+        fields.push_back(std::move(field));
+        return fields;
+    }
+    
+    // Перебор строк тела с номерами (1-based), без пустых строк и завершающего \r
+    template <typename Fn>
+    void forEachLine(const std::string& body, Fn&& fn) {
+        size_t line_no = 0;
+        size_t start = 0;
+        while (start <= body.size()) {
+            size_t end = body.find('\n', start);
+            if (end == std::string::npos) {
+                end = body.size();
+            }
+            ++line_no;
+            
+            std::string line = body.substr(start, end - start);
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (!line.empty()) {
+                fn(line_no, line);
+            }
+            start = end + 1;
+        }
+    }
+}
+
+bool isValidDate(const std::string& date) {
+    return Date::parse(date).has_value();
+}
+
+void parseNdjson(const std::string& body, std::vector<ImportRow>& rows, std::vector<ImportRowError>& errors) {
+    forEachLine(body, [&](size_t line_no, const std::string& line) {
+        try {
+            auto obj = json::parse(line);
+            ServiceRecord record{};
+            record.device_id = obj.at("device_id").get<int>();
+            record.service_id = obj.at("service_id").get<int>();
+            record.service_date = parseDate(obj.at("service_date").get<std::string>(), "service_date");
+            record.cost = obj.at("cost").get<Money>();
+            record.notes = obj.value("notes", "");
+            if (obj.contains("next_due_date") && !obj["next_due_date"].is_null()) {
+                record.next_due_date = parseDate(obj["next_due_date"].get<std::string>(), "next_due_date");
+            }
+            validateRecord(record);
+            rows.push_back({line_no, std::move(record)});
+        } catch (const std::exception& e) {
+            errors.push_back({line_no, e.what()});
+        }
+    });
+}
+
+void parseCsv(const std::string& body, std::vector<ImportRow>& rows, std::vector<ImportRowError>& errors) {
+    std::unordered_map<std::string, size_t> columns;
+    bool header_parsed = false;
+    bool header_valid = false;
+    
+    forEachLine(body, [&](size_t line_no, const std::string& line) {
+        // Без корректного заголовка строки данных не разбираются: ошибка уже записана
+        if (header_parsed && !header_valid) {
+            return;
+        }
+        
+        try {
+            auto fields = splitCsvLine(line);
+            
+            if (!header_parsed) {
+                header_parsed = true;
+                for (size_t i = 0; i < fields.size(); ++i) {
+                    columns[fields[i]] = i;
+                }
+                for (const char* required : {"device_id", "service_id", "service_date", "cost"}) {
+                    if (columns.count(required) == 0) {
+                        throw std::invalid_argument(std::string("CSV header is missing column ") + required);
+                    }
+                }
+                header_valid = true;
+                return;
+            }
+            
+            auto field = [&](const char* name) -> std::string {
+                auto it = columns.find(name);
+                if (it == columns.end() || it->second >= fields.size()) {
+                    return "";
+                }
+                return fields[it->second];
+            };
+            
+            ServiceRecord record{};
+            record.device_id = parseInt(field("device_id"), "device_id");
+            record.service_id = parseInt(field("service_id"), "service_id");
+            record.service_date = parseDate(field("service_date"), "service_date");
+            record.cost = parseMoney(field("cost"), "cost");
+            record.notes = field("notes");
+            record.next_due_date = parseDate(field("next_due_date"), "next_due_date");
+            validateRecord(record);
+            rows.push_back({line_no, std::move(record)});
+        } catch (const std::exception& e) {
+            errors.push_back({line_no, e.what()});
+        }
+    });
+}
+
+}
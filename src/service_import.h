@@ -0,0 +1,19 @@
+#pragma once
+#include "database.h"
+#include <string>
+#include <vector>
+
+// Разбор тела запроса массового импорта истории обслуживания.
+// Каждая строка проверяется независимо: корректные строки попадают в rows,
+// некорректные — в errors с номером строки и причиной.
+namespace service_import {
+    // NDJSON: один JSON-объект на строку с полями как у POST /api/service-history
+    void parseNdjson(const std::string& body, std::vector<ImportRow>& rows, std::vector<ImportRowError>& errors);
+    
+    // CSV: первая строка — заголовок с именами колонок
+    // device_id,service_id,service_date,cost[,notes][,next_due_date] в любом порядке
+    void parseCsv(const std::string& body, std::vector<ImportRow>& rows, std::vector<ImportRowError>& errors);
+    
+    // Проверка даты формата YYYY-MM-DD (включая существование дня в календаре)
+    bool isValidDate(const std::string& date);
+}
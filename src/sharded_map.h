@@ -0,0 +1,82 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Хеш-таблица со строковыми ключами, разделённая на сегменты с отдельными мьютексами:
+// потоки, обращающиеся к разным ключам, почти не конкурируют за блокировку,
+// а критическая секция — одна операция над значением.
+// Используется для счётчиков на клиента (IP, имя пользователя).
+template<typename Value, size_t SHARD_COUNT = 16>
+class ShardedMap {
+private:
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, Value> entries;
+    };
+
+    std::array<Shard, SHARD_COUNT> shards;
+
+    Shard& shardFor(const std::string& key) {
+        return shards[std::hash<std::string>{}(key) % SHARD_COUNT];
+    }
+
+public:
+    // f(Value&) под блокировкой сегмента; отсутствующая запись создаётся значением по умолчанию
+    template<typename F>
+    auto update(const std::string& key, F&& f) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return f(shard.entries[key]);
+    }
+
+    // f(Value&) только для существующей записи; false — записи нет
+    template<typename F>
+    bool updateExisting(const std::string& key, F&& f) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.entries.find(key);
+        if (it == shard.entries.end()) {
+            return false;
+        }
+        f(it->second);
+        return true;
+    }
+
+    void erase(const std::string& key) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.entries.erase(key);
+    }
+
+    // Удаление записей, для которых pred(const Value&) истинно; сегменты блокируются
+    // по очереди, поэтому обход не останавливает всю таблицу. Возвращает число удалённых
+    template<typename Pred>
+    size_t eraseIf(Pred&& pred) {
+        size_t removed = 0;
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (auto it = shard.entries.begin(); it != shard.entries.end();) {
+                if (pred(static_cast<const Value&>(it->second))) {
+                    it = shard.entries.erase(it);
+                    ++removed;
+                } else {
+                    ++it;
+                }
+            }
+        }
+        return removed;
+    }
+
+    size_t size() {
+        size_t total = 0;
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += shard.entries.size();
+        }
+        return total;
+    }
+};
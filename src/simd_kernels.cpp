@@ -0,0 +1,335 @@
+#include "simd_kernels.h"
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_KERNELS_X86 1
+#endif
+
+namespace simd_kernels {
+
+namespace {
+
+    inline bool inBitmap(const uint32_t* bitmap, size_t words, int32_t id) {
+        if (!bitmap) {
+            return true;
+        }
+        if (id < 0 || static_cast<size_t>(id) >= words * 32) {
+            return false;
+        }
+        return (bitmap[id >> 5] >> (id & 31)) & 1u;
+    }
+
+    inline bool rowMatches(const int32_t* days, const int32_t* devices, const int32_t* services,
+                           size_t i, const RowFilter& filter) {
+        return (days[i] >= filter.from_day) & (days[i] <= filter.to_day) &
+               inBitmap(filter.device_bitmap, filter.device_bitmap_words, devices[i]) &
+               inBitmap(filter.service_bitmap, filter.service_bitmap_words, services[i]);
+    }
+
+    // Скалярные реализации; векторные используют их для хвоста массива
+
+    size_t selectRowsScalar(const int32_t* days, const int32_t* devices, const int32_t* services,
+                            size_t n, const RowFilter& filter, uint32_t base, uint32_t* out_positions) {
+        size_t selected = 0;
+        for (size_t i = 0; i < n; ++i) {
+            out_positions[selected] = base + static_cast<uint32_t>(i);
+            selected += rowMatches(days, devices, services, i, filter);
+        }
+        return selected;
+    }
+
+    CostStats costStatsScalar(const int32_t* days, const int32_t* devices, const int32_t* services,
+                              const int64_t* costs, size_t n, const RowFilter& filter) {
+        CostStats stats;
+        for (size_t i = 0; i < n; ++i) {
+            if (rowMatches(days, devices, services, i, filter)) {
+                ++stats.count;
+                stats.sum += costs[i];
+                stats.min = std::min(stats.min, costs[i]);
+                stats.max = std::max(stats.max, costs[i]);
+            }
+        }
+        return stats;
+    }
+
+    uint64_t countBeforeScalar(const int32_t* days, size_t n, int32_t before, int32_t null_day) {
+        uint64_t count = 0;
+        for (size_t i = 0; i < n; ++i) {
+            count += (days[i] > null_day) & (days[i] < before);
+        }
+        return count;
+    }
+
+    void mergeStats(CostStats& into, const CostStats& other) {
+        into.count += other.count;
+        into.sum += other.sum;
+        into.min = std::min(into.min, other.min);
+        into.max = std::max(into.max, other.max);
+    }
+
+    const Kernels SCALAR_KERNELS = {Isa::Scalar, "scalar", selectRowsScalar, costStatsScalar, countBeforeScalar};
+
+#ifdef SIMD_KERNELS_X86
+
+    // ---------------- SSE4.2: 4 строки за итерацию ----------------
+
+    __attribute__((target("sse4.2")))
+    inline __m128i bitmapMask128(const uint32_t* bitmap, size_t words, const int32_t* ids) {
+        if (!bitmap) {
+            return _mm_set1_epi32(-1);
+        }
+        // В SSE нет gather: проверка принадлежности по элементам
+        return _mm_setr_epi32(inBitmap(bitmap, words, ids[0]) ? -1 : 0, inBitmap(bitmap, words, ids[1]) ? -1 : 0,
+                              inBitmap(bitmap, words, ids[2]) ? -1 : 0, inBitmap(bitmap, words, ids[3]) ? -1 : 0);
+    }
+
+    __attribute__((target("sse4.2")))
+    inline __m128i rowMask128(const int32_t* days, const int32_t* devices, const int32_t* services,
+                              size_t i, const RowFilter& filter, __m128i from, __m128i to) {
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(days + i));
+        __m128i out_of_range = _mm_or_si128(_mm_cmpgt_epi32(from, d), _mm_cmpgt_epi32(d, to));
+        __m128i mask = _mm_andnot_si128(out_of_range, _mm_set1_epi32(-1));
+        mask = _mm_and_si128(mask, bitmapMask128(filter.device_bitmap, filter.device_bitmap_words, devices + i));
+        return _mm_and_si128(mask, bitmapMask128(filter.service_bitmap, filter.service_bitmap_words, services + i));
+    }
+
+    __attribute__((target("sse4.2")))
+    size_t selectRowsSse42(const int32_t* days, const int32_t* devices, const int32_t* services,
+                           size_t n, const RowFilter& filter, uint32_t base, uint32_t* out_positions) {
+        __m128i from = _mm_set1_epi32(filter.from_day);
+        __m128i to = _mm_set1_epi32(filter.to_day);
+        size_t selected = 0;
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            int bits = _mm_movemask_ps(_mm_castsi128_ps(rowMask128(days, devices, services, i, filter, from, to)));
+            for (int lane = 0; lane < 4; ++lane) {
+                out_positions[selected] = base + static_cast<uint32_t>(i + lane);
+                selected += (bits >> lane) & 1;
+            }
+        }
+        return selected + selectRowsScalar(days + i, devices + i, services + i, n - i, filter,
+                                           base + static_cast<uint32_t>(i), out_positions + selected);
+    }
+
+    __attribute__((target("sse4.2")))
+    inline void accumulate128(__m128i cost, __m128i mask, __m128i& sum, __m128i& min, __m128i& max,
+                              __m128i max_value, __m128i min_value) {
+        sum = _mm_add_epi64(sum, _mm_and_si128(cost, mask));
+        __m128i for_min = _mm_blendv_epi8(max_value, cost, mask);
+        min = _mm_blendv_epi8(min, for_min, _mm_cmpgt_epi64(min, for_min));
+        __m128i for_max = _mm_blendv_epi8(min_value, cost, mask);
+        max = _mm_blendv_epi8(max, for_max, _mm_cmpgt_epi64(for_max, max));
+    }
+
+    __attribute__((target("sse4.2")))
+    CostStats costStatsSse42(const int32_t* days, const int32_t* devices, const int32_t* services,
+                             const int64_t* costs, size_t n, const RowFilter& filter) {
+        __m128i from = _mm_set1_epi32(filter.from_day);
+        __m128i to = _mm_set1_epi32(filter.to_day);
+        __m128i max_value = _mm_set1_epi64x(std::numeric_limits<int64_t>::max());
+        __m128i min_value = _mm_set1_epi64x(std::numeric_limits<int64_t>::min());
+        __m128i sum = _mm_setzero_si128();
+        __m128i min = max_value;
+        __m128i max = min_value;
+        uint64_t count = 0;
+
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m128i mask = rowMask128(days, devices, services, i, filter, from, to);
+            count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(mask)));
+
+            // Маска 4 x 32 бита расширяется до двух масок 2 x 64 бита под стоимость
+            __m128i mask_lo = _mm_cvtepi32_epi64(mask);
+            __m128i mask_hi = _mm_cvtepi32_epi64(_mm_srli_si128(mask, 8));
+            accumulate128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(costs + i)), mask_lo,
+                          sum, min, max, max_value, min_value);
+            accumulate128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(costs + i + 2)), mask_hi,
+                          sum, min, max, max_value, min_value);
+        }
+
+        alignas(16) int64_t lanes[2];
+        CostStats stats;
+        stats.count = count;
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), sum);
+        stats.sum = lanes[0] + lanes[1];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), min);
+        stats.min = std::min(lanes[0], lanes[1]);
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), max);
+        stats.max = std::max(lanes[0], lanes[1]);
+
+        mergeStats(stats, costStatsScalar(days + i, devices + i, services + i, costs + i, n - i, filter));
+        return stats;
+    }
+
+    __attribute__((target("sse4.2")))
+    uint64_t countBeforeSse42(const int32_t* days, size_t n, int32_t before, int32_t null_day) {
+        __m128i upper = _mm_set1_epi32(before);
+        __m128i lower = _mm_set1_epi32(null_day);
+        uint64_t count = 0;
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(days + i));
+            __m128i mask = _mm_and_si128(_mm_cmpgt_epi32(d, lower), _mm_cmpgt_epi32(upper, d));
+            count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(mask)));
+        }
+        return count + countBeforeScalar(days + i, n - i, before, null_day);
+    }
+
+    const Kernels SSE42_KERNELS = {Isa::Sse42, "sse4.2", selectRowsSse42, costStatsSse42, countBeforeSse42};
+
+    // ---------------- AVX2: 8 строк за итерацию ----------------
+
+    __attribute__((target("avx2")))
+    inline __m256i bitmapMask256(const uint32_t* bitmap, size_t words, const int32_t* ids) {
+        if (!bitmap) {
+            return _mm256_set1_epi32(-1);
+        }
+        // Слово карты загружается gather-ом только для идентификаторов в пределах карты
+        __m256i id = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ids));
+        int32_t bits = static_cast<int32_t>(std::min<size_t>(words * 32, std::numeric_limits<int32_t>::max()));
+        __m256i in_range = _mm256_and_si256(_mm256_cmpgt_epi32(id, _mm256_set1_epi32(-1)),
+                                            _mm256_cmpgt_epi32(_mm256_set1_epi32(bits), id));
+        __m256i word = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), reinterpret_cast<const int*>(bitmap),
+                                                   _mm256_srli_epi32(id, 5), in_range, 4);
+        __m256i bit = _mm256_and_si256(_mm256_srlv_epi32(word, _mm256_and_si256(id, _mm256_set1_epi32(31))),
+                                       _mm256_set1_epi32(1));
+        return _mm256_and_si256(_mm256_cmpeq_epi32(bit, _mm256_set1_epi32(1)), in_range);
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256i rowMask256(const int32_t* days, const int32_t* devices, const int32_t* services,
+                              size_t i, const RowFilter& filter, __m256i from, __m256i to) {
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(days + i));
+        __m256i out_of_range = _mm256_or_si256(_mm256_cmpgt_epi32(from, d), _mm256_cmpgt_epi32(d, to));
+        __m256i mask = _mm256_andnot_si256(out_of_range, _mm256_set1_epi32(-1));
+        mask = _mm256_and_si256(mask, bitmapMask256(filter.device_bitmap, filter.device_bitmap_words, devices + i));
+        return _mm256_and_si256(mask, bitmapMask256(filter.service_bitmap, filter.service_bitmap_words, services + i));
+    }
+
+    __attribute__((target("avx2")))
+    size_t selectRowsAvx2(const int32_t* days, const int32_t* devices, const int32_t* services,
+                          size_t n, const RowFilter& filter, uint32_t base, uint32_t* out_positions) {
+        __m256i from = _mm256_set1_epi32(filter.from_day);
+        __m256i to = _mm256_set1_epi32(filter.to_day);
+        size_t selected = 0;
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            int bits = _mm256_movemask_ps(_mm256_castsi256_ps(rowMask256(days, devices, services, i, filter, from, to)));
+            for (int lane = 0; lane < 8; ++lane) {
+                out_positions[selected] = base + static_cast<uint32_t>(i + lane);
+                selected += (bits >> lane) & 1;
+            }
+        }
+        return selected + selectRowsScalar(days + i, devices + i, services + i, n - i, filter,
+                                           base + static_cast<uint32_t>(i), out_positions + selected);
+    }
+
+    __attribute__((target("avx2")))
+    inline void accumulate256(__m256i cost, __m256i mask, __m256i& sum, __m256i& min, __m256i& max,
+                              __m256i max_value, __m256i min_value) {
+        sum = _mm256_add_epi64(sum, _mm256_and_si256(cost, mask));
+        __m256i for_min = _mm256_blendv_epi8(max_value, cost, mask);
+        min = _mm256_blendv_epi8(min, for_min, _mm256_cmpgt_epi64(min, for_min));
+        __m256i for_max = _mm256_blendv_epi8(min_value, cost, mask);
+        max = _mm256_blendv_epi8(max, for_max, _mm256_cmpgt_epi64(for_max, max));
+    }
+
+    __attribute__((target("avx2")))
+    CostStats costStatsAvx2(const int32_t* days, const int32_t* devices, const int32_t* services,
+                            const int64_t* costs, size_t n, const RowFilter& filter) {
+        __m256i from = _mm256_set1_epi32(filter.from_day);
+        __m256i to = _mm256_set1_epi32(filter.to_day);
+        __m256i max_value = _mm256_set1_epi64x(std::numeric_limits<int64_t>::max());
+        __m256i min_value = _mm256_set1_epi64x(std::numeric_limits<int64_t>::min());
+        __m256i sum = _mm256_setzero_si256();
+        __m256i min = max_value;
+        __m256i max = min_value;
+        uint64_t count = 0;
+
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i mask = rowMask256(days, devices, services, i, filter, from, to);
+            count += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(mask)));
+
+            // Маска 8 x 32 бита расширяется до двух масок 4 x 64 бита под стоимость
+            __m256i mask_lo = _mm256_cvtepi32_epi64(_mm256_castsi256_si128(mask));
+            __m256i mask_hi = _mm256_cvtepi32_epi64(_mm256_extracti128_si256(mask, 1));
+            accumulate256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(costs + i)), mask_lo,
+                          sum, min, max, max_value, min_value);
+            accumulate256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(costs + i + 4)), mask_hi,
+                          sum, min, max, max_value, min_value);
+        }
+
+        alignas(32) int64_t lanes[4];
+        CostStats stats;
+        stats.count = count;
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), sum);
+        stats.sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), min);
+        stats.min = std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), max);
+        stats.max = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+
+        mergeStats(stats, costStatsScalar(days + i, devices + i, services + i, costs + i, n - i, filter));
+        return stats;
+    }
+
+    __attribute__((target("avx2")))
+    uint64_t countBeforeAvx2(const int32_t* days, size_t n, int32_t before, int32_t null_day) {
+        __m256i upper = _mm256_set1_epi32(before);
+        __m256i lower = _mm256_set1_epi32(null_day);
+        uint64_t count = 0;
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(days + i));
+            __m256i mask = _mm256_and_si256(_mm256_cmpgt_epi32(d, lower), _mm256_cmpgt_epi32(upper, d));
+            count += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(mask)));
+        }
+        return count + countBeforeScalar(days + i, n - i, before, null_day);
+    }
+
+    const Kernels AVX2_KERNELS = {Isa::Avx2, "avx2", selectRowsAvx2, costStatsAvx2, countBeforeAvx2};
+
+#endif
+
+    bool supported(Isa isa) {
+#ifdef SIMD_KERNELS_X86
+        switch (isa) {
+            case Isa::Avx2:
+                return __builtin_cpu_supports("avx2");
+            case Isa::Sse42:
+                return __builtin_cpu_supports("sse4.2");
+            case Isa::Scalar:
+                return true;
+        }
+        return false;
+#else
+        return isa == Isa::Scalar;
+#endif
+    }
+
+}
+
+const Kernels& kernels(Isa isa) {
+#ifdef SIMD_KERNELS_X86
+    if (isa == Isa::Avx2 && supported(Isa::Avx2)) {
+        return AVX2_KERNELS;
+    }
+    if (isa == Isa::Sse42 && supported(Isa::Sse42)) {
+        return SSE42_KERNELS;
+    }
+#else
+    (void)isa;
+#endif
+    return SCALAR_KERNELS;
+}
+
+const Kernels& best() {
+    static const Kernels& selected = supported(Isa::Avx2)  ? kernels(Isa::Avx2)
+                                   : supported(Isa::Sse42) ? kernels(Isa::Sse42)
+                                                           : kernels(Isa::Scalar);
+    return selected;
+}
+
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// Векторные ядра фильтрации и агрегации по столбцам истории обслуживания
+// (даты — дни от 1970-01-01, стоимость — копейки). Реализации AVX2 и SSE4.2
+// выбираются во время выполнения по возможностям процессора, иначе — скалярная.
+namespace simd_kernels {
+
+    enum class Isa { Scalar, Sse42, Avx2 };
+
+    // Фильтр строк: даты включительно; bitmap == nullptr — без фильтра по идентификатору.
+    // Битовая карта: бит id установлен, если идентификатор входит в множество
+    struct RowFilter {
+        int32_t from_day = std::numeric_limits<int32_t>::min();
+        int32_t to_day = std::numeric_limits<int32_t>::max();
+        const uint32_t* device_bitmap = nullptr;
+        size_t device_bitmap_words = 0;
+        const uint32_t* service_bitmap = nullptr;
+        size_t service_bitmap_words = 0;
+    };
+
+    struct CostStats {
+        uint64_t count = 0;
+        int64_t sum = 0;
+        int64_t min = std::numeric_limits<int64_t>::max();
+        int64_t max = std::numeric_limits<int64_t>::min();
+    };
+
+    struct Kernels {
+        Isa isa;
+        const char* name;
+
+        // Позиции (base + i) строк, прошедших фильтр; возвращает их количество.
+        // out_positions должен вмещать n элементов
+        size_t (*select_rows)(const int32_t* days, const int32_t* devices, const int32_t* services,
+                              size_t n, const RowFilter& filter, uint32_t base, uint32_t* out_positions);
+
+        // count/sum/min/max стоимости по строкам, прошедшим фильтр
+        CostStats (*cost_stats)(const int32_t* days, const int32_t* devices, const int32_t* services,
+                                const int64_t* costs, size_t n, const RowFilter& filter);
+
+        // Количество дат в интервале (null_day, before): просроченные next_due_date
+        uint64_t (*count_before)(const int32_t* days, size_t n, int32_t before, int32_t null_day);
+    };
+
+    // Реализация для isa; если процессор её не поддерживает — скалярная
+    const Kernels& kernels(Isa isa);
+
+    // Лучшая доступная реализация (определяется один раз)
+    const Kernels& best();
+
+}
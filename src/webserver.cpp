@@ -1,8 +1,16 @@
 #include "webserver.h"
 #include "metrics.h"
+#include "service_import.h"
+#include "service_export.h"
+#include "json_writer.h"
+#include "request_arena.h"
 #include <fstream>
 #include <iostream>
 #include <chrono>
+#include <algorithm>
+#include <charconv>
+#include <limits>
+#include <string_view>
 
 WebServer::WebServer(const std::string& config_file) : port(8080) {
     // Инициализация логгера с поддержкой Loki
@@ -32,9 +40,72 @@ WebServer::WebServer(const std::string& config_file) : port(8080) {
             "user=" + config["database"]["user"].get<std::string>() + " " +
             "password=" + config["database"]["password"].get<std::string>();
         
+        // Аутентификация: секрет подписи токенов, срок их действия и стоимость PBKDF2
+        json auth_config = config.value("auth", json::object());
+        std::string secret = auth_config.value("secret", "");
+        if (secret.empty()) {
+            secret = auth::randomSecret();
+            Logger::getInstance().warning("auth.secret is not set: using a random secret, "
+                                          "issued tokens will not survive a restart", "webserver.cpp");
+        }
+        token_signer = std::make_shared<auth::TokenSigner>(secret);
+        app.get_middleware<AuthMiddleware>().configure(token_signer);
+        token_ttl = std::chrono::seconds(auth_config.value("token_ttl_seconds", 3600));
+        pbkdf2_iterations = auth_config.value("pbkdf2_iterations", 310000);
+        dummy_password_hash = auth::hashPassword(auth::randomSecret(), pbkdf2_iterations);
+        auth_executor = std::make_unique<DbExecutor>(auth_config.value("kdf_threads", 2));
+        
+        json throttle_config = auth_config.value("login_throttle", json::object());
+        LoginThrottle::Settings throttle_settings;
+        throttle_settings.max_attempts_per_ip = throttle_config.value("max_attempts_per_ip", 20u);
+        throttle_settings.max_attempts_per_user = throttle_config.value("max_attempts_per_user", 5u);
+        throttle_settings.window = std::chrono::seconds(throttle_config.value("window_seconds", 300));
+        login_throttle = std::make_unique<LoginThrottle>(throttle_settings);
+        
+        // Ограничение частоты запросов по группам маршрутов; первая совпавшая группа
+        json rate_config = config.value("rate_limits", json::object());
+        if (rate_config.value("enabled", false)) {
+            std::vector<RateLimiter::Group> groups;
+            for (const auto& group_config : rate_config.value("groups", json::array())) {
+                RateLimiter::Group group;
+                group.name = group_config.at("name").get<std::string>();
+                group.prefix = group_config.at("prefix").get<std::string>();
+                group.rate_per_second = group_config.value("rate_per_second", group.rate_per_second);
+                group.burst = group_config.value("burst", group.burst);
+                groups.push_back(std::move(group));
+            }
+            Logger::getInstance().info("Rate limiting enabled for " + std::to_string(groups.size()) +
+                                       " route groups", "webserver.cpp");
+            app.get_middleware<RateLimitMiddleware>().configure(std::make_unique<RateLimiter>(std::move(groups)));
+        }
+        
         Logger::getInstance().info("Connecting to database...", "webserver.cpp");
         
-        db = std::make_unique<Database>(conn_str);
+        size_t pool_size = config["database"].value("pool_size", 4);
+        db = std::make_unique<Database>(conn_str, pool_size);
+        db->setBinaryResults(config["database"].value("binary_results", false));
+        
+        json pipeline_config = config["database"].value("pipeline", json::object());
+        db->setPipelineSettings(
+            std::chrono::microseconds(static_cast<long long>(pipeline_config.value("window_ms", 2.0) * 1000)),
+            pipeline_config.value("max_batch", 32u));
+        
+        json deadline_config = config.value("deadlines", json::object());
+        default_deadline = std::chrono::milliseconds(deadline_config.value("default_ms", 0));
+        for (const auto& route_config : deadline_config.value("routes", json::array())) {
+            route_deadlines.push_back({route_config.at("prefix").get<std::string>(),
+                                       std::chrono::milliseconds(route_config.at("timeout_ms").get<int>())});
+        }
+        
+        json limit_config = config["database"].value("concurrency_limit", json::object());
+        if (limit_config.value("enabled", false)) {
+            ConcurrencyLimiter::Settings limit_settings;
+            limit_settings.initial_limit = limit_config.value("initial", static_cast<double>(pool_size * 2));
+            limit_settings.min_limit = limit_config.value("min", limit_settings.min_limit);
+            limit_settings.max_limit = limit_config.value("max", limit_settings.max_limit);
+            limit_settings.latency_threshold = std::chrono::milliseconds(limit_config.value("latency_threshold_ms", 250));
+            db_limiter = std::make_unique<ConcurrencyLimiter>(limit_settings);
+        }
         
         if (!db->connect()) {
             Logger::getInstance().error("Failed to connect to database", "webserver.cpp");
@@ -45,6 +116,27 @@ WebServer::WebServer(const std::string& config_file) : port(8080) {
         Logger::getInstance().info("Connected to database successfully", "webserver.cpp");
         Logger::getInstance().logDatabase("connect", true, "Database connection established");
         
+        // Недостающие индексы и расширения схемы применяются до приёма запросов
+        int schema_version = db->migrate();
+        if (schema_version < 0) {
+            Logger::getInstance().error("Schema migration failed", "webserver.cpp");
+            Logger::getInstance().logDatabase("migrate", false, "Schema migration failed");
+        } else {
+            Logger::getInstance().info("Schema version: " + std::to_string(schema_version), "webserver.cpp");
+        }
+        
+        // Пул потоков для запросов к БД по размеру пула соединений
+        db_executor = std::make_unique<DbExecutor>(db->poolSize());
+        Logger::getInstance().info("DB executor started with " + std::to_string(db_executor->threadCount()) +
+                                   " threads", "webserver.cpp");
+        
+        // Колоночная копия истории для /api/analytics (отдельное соединение с LISTEN)
+        if (config.contains("analytics") && config["analytics"].value("enabled", false)) {
+            analytics = std::make_unique<AnalyticsStore>(conn_str);
+            analytics->start();
+            Logger::getInstance().info("Analytics store started", "webserver.cpp");
+        }
+        
         port = config["server"]["port"].get<int>();
         Logger::getInstance().info("Server configured for port: " + std::to_string(port), "webserver.cpp");
         
@@ -61,11 +153,408 @@ WebServer::WebServer(const std::string& config_file) : port(8080) {
     }
 }
 
+// Обработчик отдаёт управление I/O потоку Crow сразу, а ответ
+// завершается из потока DbExecutor после выполнения запроса к БД
+namespace {
+    // Максимальный размер пакета в batch-эндпоинтах
+    const size_t MAX_BATCH_SIZE = 10000;
+    
+    // Ограничения параметров списков (limit и длина строки поиска)
+    const int MAX_PAGE_SIZE = 10000;
+    const size_t MAX_SEARCH_LENGTH = 100;
+    
+    // /api/search: триграммный индекс помогает только запросам от трёх символов
+    const size_t MIN_QUERY_CHARS = 3;
+    const int DEFAULT_SEARCH_LIMIT = 20;
+    const int MAX_SEARCH_LIMIT = 100;
+    
+    // /api/devices/<id>/history без limit
+    const int DEFAULT_DEVICE_HISTORY_LIMIT = 100;
+    
+    // /api/dashboard: число последних записей истории (history_limit)
+    const int MAX_DASHBOARD_HISTORY = 500;
+    
+    // /api/maintenance/upcoming: горизонт в днях (days)
+    const int MAX_UPCOMING_DAYS = 365;
+    
+    // /api/export/service-history: ответ собирается в памяти целиком (Crow не отдаёт тело
+    // по частям), поэтому выгрузка идёт страницами по record_id (after_id); размер страницы (limit)
+    const int MAX_EXPORT_PAGE_SIZE = 50000;
+    
+    // Число символов UTF-8 (байты продолжения 10xxxxxx не считаются)
+    size_t utf8Length(const std::string& text) {
+        return static_cast<size_t>(std::count_if(text.begin(), text.end(), [](char c) {
+            return (static_cast<unsigned char>(c) & 0xC0) != 0x80;
+        }));
+    }
+    
+    ServiceRecord serviceRecordFromJson(const json& body) {
+        ServiceRecord record{};
+        record.id = body.value("id", 0);
+        record.device_id = body.at("device_id").get<int>();
+        record.service_id = body.at("service_id").get<int>();
+        record.service_date = body.at("service_date").get<Date>();
+        if (record.service_date.isNull()) {
+            throw std::invalid_argument("service_date is required");
+        }
+        record.cost = body.at("cost").get<Money>();
+        record.notes = body.value("notes", "");
+        if (body.contains("next_due_date") && !body["next_due_date"].is_null()) {
+            record.next_due_date = body["next_due_date"].get<Date>();
+        }
+        return record;
+    }
+    
+    json serviceRecordToJson(const ServiceRecord& record) {
+        json j;
+        j["id"] = record.id;
+        j["device_id"] = record.device_id;
+        j["service_id"] = record.service_id;
+        j["service_date"] = record.service_date;
+        j["cost"] = record.cost;
+        j["notes"] = record.notes;
+        j["next_due_date"] = record.next_due_date;
+        return j;
+    }
+    
+    // Сериализация представлений строк прямо в тело ответа (без дерева json)
+    void writeJson(JsonWriter& writer, const DeviceView& device) {
+        writer.beginObject();
+        writer.key("id").value(device.id);
+        writer.key("name").value(device.name);
+        writer.key("model").value(device.model);
+        writer.key("purchase_date").value(device.purchase_date);
+        writer.key("status").value(device.status);
+        writer.endObject();
+    }
+    
+    void writeJson(JsonWriter& writer, const ServiceTypeView& type) {
+        writer.beginObject();
+        writer.key("id").value(type.id);
+        writer.key("name").value(type.name);
+        writer.key("recommended_interval_months").value(type.recommended_interval_months);
+        writer.key("standard_cost").value(type.standard_cost);
+        writer.endObject();
+    }
+    
+    void writeJson(JsonWriter& writer, const ServiceRecordView& record) {
+        writer.beginObject();
+        writer.key("id").value(record.id);
+        writer.key("device_id").value(record.device_id);
+        writer.key("service_id").value(record.service_id);
+        writer.key("service_date").value(record.service_date);
+        writer.key("cost").value(record.cost);
+        writer.key("notes").value(record.notes);
+        writer.key("next_due_date").value(record.next_due_date);
+        writer.endObject();
+    }
+    
+    // Поле next_due_date детализированной истории исторически отдаётся пустой строкой при NULL
+    void writeJson(JsonWriter& writer, const DetailedRecordView& record) {
+        writer.beginObject();
+        writer.key("record_id").value(record.record_id);
+        writer.key("device_name").value(record.device_name);
+        writer.key("model").value(record.model);
+        writer.key("service_name").value(record.service_name);
+        writer.key("service_date").value(record.service_date);
+        writer.key("cost").value(record.cost);
+        writer.key("notes").value(record.notes);
+        writer.key("next_due_date");
+        if (record.next_due_date.isNull()) {
+            writer.value(std::string_view());
+        } else {
+            writer.value(record.next_due_date);
+        }
+        writer.endObject();
+    }
+    
+    // JSON-массив строк в арене запроса; row_size — оценка размера объекта для резервирования буфера
+    template<typename Rows>
+    std::pmr::string rowsToJson(const Rows& rows, size_t row_size) {
+        std::pmr::string body(RequestArena::resource());
+        body.reserve(rows.size() * row_size + 2);
+        JsonWriter writer(body);
+        writer.beginArray();
+        for (const auto& row : rows) {
+            writeJson(writer, row);
+        }
+        writer.endArray();
+        return body;
+    }
+    
+    // Тело из арены переносится в ответ одним выделением точного размера:
+    // crow::response переживает RequestArena::Scope
+    std::string responseBody(const std::pmr::string& body) {
+        return std::string(body.data(), body.size());
+    }
+    
+    // Ответ пакетной операции: 200 при успехе, 400 при откате транзакции
+    crow::response batchResponse(const std::string& method, const std::string& operation,
+                                 const BatchResult& result,
+                                 std::chrono::high_resolution_clock::time_point start_time) {
+        json response;
+        response["success"] = result.success;
+        response["count"] = result.ids.size();
+        response["record_ids"] = result.ids;
+        if (!result.success) {
+            response["error"] = result.error;
+        }
+        
+        int status = result.success ? 200 : 400;
+        auto end_time = std::chrono::high_resolution_clock::now();
+        long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+        
+        // Record Prometheus metrics
+        auto& metrics = MetricsRegistry::getInstance();
+        metrics.recordHttpRequest(method, "/api/service-history/batch", status, duration_ms / 1000.0);
+        metrics.recordDbOperation(operation, result.success);
+        
+        crow::response res(status);
+        res.set_header("Content-Type", "application/json; charset=utf-8");
+        res.set_header("Access-Control-Allow-Origin", "*");
+        res.body = response.dump();
+        return res;
+    }
+    
+    // Целое в диапазоне [min, max] без посторонних символов
+    bool parseInt(std::string_view param, int min, int max, int& value) {
+        const char* end = param.data() + param.size();
+        auto [ptr, ec] = std::from_chars(param.data(), end, value);
+        return ec == std::errc() && ptr == end && value >= min && value <= max;
+    }
+    
+    // Список положительных идентификаторов через запятую: "1,2,5".
+    // Любой некорректный элемент ("5abc", пустой, 0) отклоняет весь список
+    bool parseIdList(std::string_view param, std::vector<int32_t>& ids) {
+        size_t start = 0;
+        while (start <= param.size()) {
+            size_t end = param.find(',', start);
+            if (end == std::string_view::npos) {
+                end = param.size();
+            }
+            int id = 0;
+            if (!parseInt(param.substr(start, end - start), 1, std::numeric_limits<int32_t>::max(), id)) {
+                ids.clear();
+                return false;
+            }
+            ids.push_back(id);
+            start = end + 1;
+        }
+        return !ids.empty();
+    }
+    
+    // Общие параметры списков: sort=<ключ>, order=asc|desc, limit, offset
+    bool parseListParams(const crow::query_string& params, bool (*is_sort_key)(const std::string&),
+                         std::string& sort, bool& descending, int& limit, int& offset) {
+        bool valid = true;
+        if (const char* sort_param = params.get("sort")) {
+            sort = sort_param;
+            valid = valid && is_sort_key(sort);
+        }
+        if (const char* order_param = params.get("order")) {
+            std::string order = order_param;
+            valid = valid && (order == "asc" || order == "desc");
+            descending = order == "desc";
+        }
+        if (const char* limit_param = params.get("limit")) {
+            valid = valid && parseInt(limit_param, 1, MAX_PAGE_SIZE, limit);
+        }
+        if (const char* offset_param = params.get("offset")) {
+            valid = valid && parseInt(offset_param, 0, std::numeric_limits<int>::max(), offset);
+        }
+        return valid;
+    }
+    
+    // Подстрока поиска: непустая, не длиннее MAX_SEARCH_LENGTH
+    bool parseSearch(const crow::query_string& params, std::string& search) {
+        if (const char* search_param = params.get("search")) {
+            search = search_param;
+            return !search.empty() && search.size() <= MAX_SEARCH_LENGTH;
+        }
+        return true;
+    }
+    
+    bool parseDeviceQuery(const crow::query_string& params, DeviceQuery& query) {
+        bool valid = parseListParams(params, &Database::isDeviceSortKey, query.sort, query.descending,
+                                     query.limit, query.offset);
+        if (const char* id_param = params.get("id")) {
+            valid = valid && parseIdList(id_param, query.ids);
+        }
+        if (const char* status_param = params.get("status")) {
+            query.status = status_param;
+            valid = valid && !query.status.empty() && query.status.size() <= 20;
+        }
+        return valid && parseSearch(params, query.search);
+    }
+    
+    bool parseHistoryQuery(const crow::query_string& params, HistoryQuery& query) {
+        bool valid = parseListParams(params, &Database::isHistorySortKey, query.sort, query.descending,
+                                     query.limit, query.offset);
+        if (const char* device_param = params.get("device_id")) {
+            valid = valid && parseIdList(device_param, query.device_ids);
+        }
+        if (const char* service_param = params.get("service_id")) {
+            valid = valid && parseIdList(service_param, query.service_ids);
+        }
+        if (const char* from_param = params.get("from")) {
+            auto day = Date::parse(from_param);
+            valid = valid && day.has_value();
+            query.from = day.value_or(Date());
+        }
+        if (const char* to_param = params.get("to")) {
+            auto day = Date::parse(to_param);
+            valid = valid && day.has_value();
+            query.to = day.value_or(Date());
+        }
+        if (const char* min_param = params.get("min_cost")) {
+            query.min_cost = Money::parse(min_param);
+            valid = valid && query.min_cost && *query.min_cost >= Money();
+        }
+        if (const char* max_param = params.get("max_cost")) {
+            query.max_cost = Money::parse(max_param);
+            valid = valid && query.max_cost && *query.max_cost >= Money();
+        }
+        return valid && parseSearch(params, query.search);
+    }
+    
+    // 400 для недопустимых параметров списка (до обращения к БД)
+    crow::response listRequestError(const std::string& path, const std::string& error) {
+        MetricsRegistry::getInstance().recordHttpRequest("GET", path, 400, 0.0);
+        
+        json response;
+        response["success"] = false;
+        response["error"] = error;
+        
+        crow::response res(400);
+        res.set_header("Content-Type", "application/json; charset=utf-8");
+        res.set_header("Access-Control-Allow-Origin", "*");
+        res.body = response.dump();
+        return res;
+    }
+    
+    crow::response batchRequestError(const std::string& method, const std::string& error) {
+        MetricsRegistry::getInstance().recordHttpRequest(method, "/api/service-history/batch", 400, 0.0);
+        
+        json response;
+        response["success"] = false;
+        response["error"] = error;
+        
+        crow::response res(400);
+        res.set_header("Content-Type", "application/json; charset=utf-8");
+        res.set_header("Access-Control-Allow-Origin", "*");
+        res.body = response.dump();
+        return res;
+    }
+    
+    // 504: срок запроса (deadlines) истёк
+    crow::response gatewayTimeout() {
+        json response;
+        response["success"] = false;
+        response["error"] = "Request deadline exceeded";
+        
+        crow::response res(504);
+        res.set_header("Content-Type", "application/json; charset=utf-8");
+        res.set_header("Access-Control-Allow-Origin", "*");
+        res.body = response.dump();
+        return res;
+    }
+    
+    // 503 при исчерпанном лимите одновременных запросов к БД
+    crow::response serviceOverloaded() {
+        json response;
+        response["success"] = false;
+        response["error"] = "Service overloaded, retry later";
+        
+        crow::response res(503);
+        res.set_header("Content-Type", "application/json; charset=utf-8");
+        res.set_header("Access-Control-Allow-Origin", "*");
+        res.set_header("Retry-After", "1");
+        res.body = response.dump();
+        return res;
+    }
+    
+    // 429 от ограничителя попыток входа: без логов и меток с именем пользователя
+    crow::response tooManyLoginAttempts(std::chrono::seconds retry_after) {
+        json response;
+        response["success"] = false;
+        response["error"] = "Too many login attempts";
+        
+        crow::response res(429);
+        res.set_header("Content-Type", "application/json; charset=utf-8");
+        res.set_header("Access-Control-Allow-Origin", "*");
+        res.set_header("Retry-After", std::to_string(retry_after.count()));
+        res.body = response.dump();
+        return res;
+    }
+}
+
+std::optional<RequestDeadline::Clock::time_point> WebServer::deadlineFor(const std::string& path) const {
+    std::chrono::milliseconds timeout = default_deadline;
+    for (const auto& route : route_deadlines) {
+        if (path.compare(0, route.prefix.size(), route.prefix) == 0) {
+            timeout = route.timeout;
+            break;
+        }
+    }
+    if (timeout.count() <= 0) {
+        return std::nullopt;
+    }
+    return RequestDeadline::Clock::now() + timeout;
+}
+
+void WebServer::dispatchDb(const crow::request& req, crow::response& res, std::function<crow::response()> work) {
+    // Срок отсчитывается с момента поступления в пул: ожидание в очереди тоже входит в него
+    auto deadline = deadlineFor(req.url);
+    
+    // Сверх адаптивного лимита — сразу 503, без ожидания в очереди пула
+    if (db_limiter && !db_limiter->tryAcquire()) {
+        MetricsRegistry::getInstance().recordDbRequestShed();
+        res = serviceOverloaded();
+        res.end();
+        return;
+    }
+    
+    dispatchTo(*db_executor, res,
+               admitDbTask(std::move(work), db_limiter.get(), ConcurrencyLimiter::Clock::now()), deadline);
+}
+
+void WebServer::dispatchTo(DbExecutor& executor, crow::response& res, std::function<crow::response()> work,
+                           std::optional<RequestDeadline::Clock::time_point> deadline) {
+    executor.submit([&res, work = std::move(work), deadline]() {
+        // Временные объекты обработчика живут в арене потока до конца запроса
+        RequestArena::Scope arena_scope;
+        RequestDeadline::Scope deadline_scope(deadline);
+        try {
+            // Запрос, прерванный statement_timeout, Database поднимает как DeadlineExceeded("database");
+            // успешно завершённая работа отдаётся, даже если срок истёк после неё
+            res = work();
+        } catch (const DeadlineExceeded& e) {
+            MetricsRegistry::getInstance().recordDeadlineExceeded(e.what());
+            res = gatewayTimeout();
+        } catch (const std::exception& e) {
+            Logger::getInstance().error(std::string("DB task error: ") + e.what(), "webserver.cpp");
+            
+            json response;
+            response["success"] = false;
+            response["error"] = e.what();
+            
+            res = crow::response(500);
+            res.set_header("Content-Type", "application/json; charset=utf-8");
+            res.set_header("Access-Control-Allow-Origin", "*");
+            res.body = response.dump();
+        }
+        res.end();
+    });
+}
+
 void WebServer::setupRoutes() {
     // Prometheus metrics endpoint - must be defined BEFORE catch-all route
     CROW_ROUTE(app, "/metrics")
-    ([]() {
+    ([this]() {
         auto& metrics = MetricsRegistry::getInstance();
+        if (db_limiter) {
+            metrics.recordDbConcurrency(db_limiter->limit(), db_limiter->inFlight());
+        }
         std::string output = metrics.format();
         
         crow::response res;
@@ -135,85 +624,88 @@ void WebServer::setupRoutes() {
     
     // API: Тест подключения к БД
     CROW_ROUTE(app, "/api/test-db")
-    ([this]() {
-        auto start_time = std::chrono::high_resolution_clock::now();
-        bool connected = db->testConnection();
+    ([this](const crow::request& req, crow::response& res) {
+        dispatchDb(req, res, [this]() {
+            auto start_time = std::chrono::high_resolution_clock::now();
+            bool connected = db->testConnection();
         
-        json response;
-        response["database_connected"] = connected;
-        response["timestamp"] = std::time(nullptr);
+            json response;
+            response["database_connected"] = connected;
+            response["timestamp"] = std::time(nullptr);
         
-        auto end_time = std::chrono::high_resolution_clock::now();
-        long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+            auto end_time = std::chrono::high_resolution_clock::now();
+            long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
         
-        // Record Prometheus metrics
-        auto& metrics = MetricsRegistry::getInstance();
-        metrics.recordHttpRequest("GET", "/api/test-db", 200, duration_ms / 1000.0);
-        metrics.recordDbOperation("test_connection", connected);
+            // Record Prometheus metrics
+            auto& metrics = MetricsRegistry::getInstance();
+            metrics.recordHttpRequest("GET", "/api/test-db", 200, duration_ms / 1000.0);
+            metrics.recordDbOperation("test_connection", connected);
         
-        crow::response res(200);
-        res.set_header("Content-Type", "application/json; charset=utf-8");
-        res.set_header("Access-Control-Allow-Origin", "*");
-        res.body = response.dump();
-        return res;
+            crow::response res(200);
+            res.set_header("Content-Type", "application/json; charset=utf-8");
+            res.set_header("Access-Control-Allow-Origin", "*");
+            res.body = response.dump();
+            return res;
+        });
     });
     
-    // API: Авторизация пользователя с логированием
-    CROW_ROUTE(app, "/api/login")
-    .methods("POST"_method)
-    ([this](const crow::request& req) {
-        auto start_time = std::chrono::high_resolution_clock::now();
-        std::string client_ip = req.remote_ip_address.empty() ? "unknown" : req.remote_ip_address;
+    // API: Данные главной страницы одним запросом (один снимок БД; выборки одновременных
+    // запросов уходят общим пакетом pipeline libpq)
+    CROW_ROUTE(app, "/api/dashboard")
+    .methods("GET"_method)
+    ([this](const crow::request& req, crow::response& res) {
+        int history_limit = 20;
+        const char* limit_param = req.url_params.get("history_limit");
+        if (limit_param && !parseInt(limit_param, 1, MAX_DASHBOARD_HISTORY, history_limit)) {
+            res = listRequestError("/api/dashboard",
+                                   "history_limit must be an integer from 1 to " + std::to_string(MAX_DASHBOARD_HISTORY));
+            res.end();
+            return;
+        }
         
-        try {
-            auto body = json::parse(req.body);
-            std::string username = body["username"].get<std::string>();
-            std::string password = body["password"].get<std::string>();
-            
-            // Логируем попытку авторизации
-            Logger::getInstance().logAuth(username, true, client_ip, "Login attempt started");
-            
-            // Простая проверка логина и пароля (в реальном проекте использовать хеширование)
-            bool auth_success = false;
-            std::string auth_message;
-            
-            if (username == "admin" && password == "admin123") {
-                auth_success = true;
-                auth_message = "Administrator login successful";
-                Logger::getInstance().info("Admin user authenticated successfully", "webserver.cpp");
-            } else if (username == "user" && password == "user123") {
-                auth_success = true;
-                auth_message = "User login successful";
-                Logger::getInstance().info("Regular user authenticated successfully", "webserver.cpp");
-            } else {
-                auth_success = false;
-                auth_message = "Invalid credentials";
-                Logger::getInstance().logAuth(username, false, client_ip, "Invalid username or password");
-            }
-            
-            json response;
-            response["success"] = auth_success;
-            response["message"] = auth_message;
-            response["username"] = username;
-            response["token"] = auth_success ? "mock-jwt-token-" + username : "";
+        dispatchDb(req, res, [this, history_limit]() {
+            auto start_time = std::chrono::high_resolution_clock::now();
+            json dashboard = db->getDashboard(history_limit);
+            dashboard["timestamp"] = std::time(nullptr);
+            bool connected = dashboard["database_connected"].get<bool>();
             
             auto end_time = std::chrono::high_resolution_clock::now();
             long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
             
-            Logger::getInstance().logRequest(client_ip, "POST", "/api/login", 
-                                              auth_success ? 200 : 401, duration_ms);
-            
             // Record Prometheus metrics
             auto& metrics = MetricsRegistry::getInstance();
-            metrics.recordAuthAttempt(username, auth_success);
-            metrics.recordHttpRequest("POST", "/api/login", auth_success ? 200 : 401, duration_ms / 1000.0);
+            metrics.recordHttpRequest("GET", "/api/dashboard", 200, duration_ms / 1000.0);
+            metrics.recordDbOperation("get_dashboard", connected);
             
-            crow::response res(auth_success ? 200 : 401);
+            crow::response res(200);
             res.set_header("Content-Type", "application/json; charset=utf-8");
             res.set_header("Access-Control-Allow-Origin", "*");
-            res.body = response.dump();
+            res.body = dashboard.dump();
             return res;
-            
+        });
+    });
+    
+    // API: Авторизация пользователя с логированием
+    CROW_ROUTE(app, "/api/login")
+    .methods("POST"_method)
+    ([this](const crow::request& req, crow::response& res) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        std::string client_ip = req.remote_ip_address.empty() ? "unknown" : req.remote_ip_address;
+        
+        // Лимит попыток с одного IP проверяется до разбора тела, логов и метрик с метками
+        if (auto retry_after = login_throttle->admitIp(client_ip); retry_after.count() > 0) {
+            MetricsRegistry::getInstance().recordLoginThrottled("ip");
+            res = tooManyLoginAttempts(retry_after);
+            res.end();
+            return;
+        }
+        
+        std::string username;
+        std::string password;
+        try {
+            auto body = json::parse(req.body);
+            username = body["username"].get<std::string>();
+            password = body["password"].get<std::string>();
         } catch (const std::exception& e) {
             auto end_time = std::chrono::high_resolution_clock::now();
             long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
@@ -229,75 +721,145 @@ void WebServer::setupRoutes() {
             response["success"] = false;
             response["error"] = e.what();
             
-            crow::response res(400);
+            res = crow::response(400);
             res.set_header("Content-Type", "application/json; charset=utf-8");
             res.set_header("Access-Control-Allow-Origin", "*");
             res.body = response.dump();
-            return res;
+            res.end();
+            return;
         }
-    });
-    
-    // API: Выход пользователя с логированием
-    CROW_ROUTE(app, "/api/logout")
-    .methods("POST"_method)
-    ([this](const crow::request& req) {
-        auto start_time = std::chrono::high_resolution_clock::now();
-        std::string client_ip = req.remote_ip_address.empty() ? "unknown" : req.remote_ip_address;
-        
-        // Логируем выход пользователя
-        Logger::getInstance().info("User logout successful", "webserver.cpp");
-        
-        // Record Prometheus metrics
-        auto& metrics = MetricsRegistry::getInstance();
-        metrics.recordHttpRequest("POST", "/api/logout", 200, 0.001);
-        metrics.recordDbOperation("logout", true);
         
-        Logger::getInstance().logRequest(client_ip, "POST", "/api/logout", 200, 1);
+        if (auto retry_after = login_throttle->admitUser(username); retry_after.count() > 0) {
+            MetricsRegistry::getInstance().recordLoginThrottled("user");
+            res = tooManyLoginAttempts(retry_after);
+            res.end();
+            return;
+        }
         
-        json response;
-        response["success"] = true;
-        response["message"] = "Logged out successfully";
+        // Логируем попытку авторизации
+        Logger::getInstance().logAuth(username, true, client_ip, "Login attempt started");
         
-        crow::response res(200);
-        res.set_header("Content-Type", "application/json; charset=utf-8");
-        res.set_header("Access-Control-Allow-Origin", "*");
-        res.body = response.dump();
-        return res;
-    });
+        // Поиск пользователя и PBKDF2 (сотни миллисекунд) — в пуле auth_executor
+        dispatchTo(*auth_executor, res, [this, username, password, client_ip, start_time]() {
+            auto user = db->getUser(username);
+            
+            // Для неизвестного пользователя хеш всё равно вычисляется:
+            // по времени ответа нельзя определить, существует ли логин
+            auto verify_start = std::chrono::steady_clock::now();
+            bool auth_success = auth::verifyPassword(password, user ? user->password_hash : dummy_password_hash) &&
+                                user.has_value();
+            std::chrono::duration<double> verify_time = std::chrono::steady_clock::now() - verify_start;
+            MetricsRegistry::getInstance().recordPasswordVerification(auth_success, verify_time.count());
+            
+            json response;
+            response["success"] = auth_success;
+            response["username"] = username;
+            
+            if (auth_success) {
+                login_throttle->forgive(client_ip, username);
+                
+                // Хеш со старым числом итераций пересчитывается, пока пароль известен
+                if (auth::hashIterations(user->password_hash) < pbkdf2_iterations) {
+                    db->updatePasswordHash(user->id, auth::hashPassword(password, pbkdf2_iterations));
+                }
+                
+                response["message"] = user->role == "admin" ? "Administrator login successful" : "User login successful";
+                response["role"] = user->role;
+                response["token"] = token_signer->issue(user->username, user->role, token_ttl);
+                response["expires_in"] = token_ttl.count();
+                Logger::getInstance().info("User " + username + " authenticated successfully", "webserver.cpp");
+            } else {
+                response["message"] = "Invalid credentials";
+                response["token"] = "";
+                Logger::getInstance().logAuth(username, false, client_ip, "Invalid username or password");
+            }
+            
+            auto end_time = std::chrono::high_resolution_clock::now();
+            long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+            
+            Logger::getInstance().logRequest(client_ip, "POST", "/api/login", 
+                                              auth_success ? 200 : 401, duration_ms);
+            
+            // Record Prometheus metrics
+            auto& metrics = MetricsRegistry::getInstance();
+            metrics.recordAuthAttempt(username, auth_success);
+            metrics.recordHttpRequest("POST", "/api/login", auth_success ? 200 : 401, duration_ms / 1000.0);
+            
+            crow::response res(auth_success ? 200 : 401);
+            res.set_header("Content-Type", "application/json; charset=utf-8");
+            res.set_header("Access-Control-Allow-Origin", "*");
+            res.body = response.dump();
+            return res;
+        });
+    });
     
-    // API: Получение всех устройств
-    CROW_ROUTE(app, "/api/devices")
-    .methods("GET"_method)
-    ([this]() {
+    // API: Выход пользователя с логированием
+    CROW_ROUTE(app, "/api/logout")
+    .methods("POST"_method)
+    ([this](const crow::request& req) {
         auto start_time = std::chrono::high_resolution_clock::now();
-        auto devices = db->getAllDevices();
-        json result = json::array();
-        
-        for (const auto& device : devices) {
-            json j;
-            j["id"] = device.id;
-            j["name"] = device.name;
-            j["model"] = device.model;
-            j["purchase_date"] = device.purchase_date;
-            j["status"] = device.status;
-            result.push_back(j);
-        }
+        std::string client_ip = req.remote_ip_address.empty() ? "unknown" : req.remote_ip_address;
         
-        auto end_time = std::chrono::high_resolution_clock::now();
-        long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+        // Токены не хранятся на сервере: клиент удаляет свой токен,
+        // а срок его действия ограничен auth.token_ttl_seconds
+        // Логируем выход пользователя
+        Logger::getInstance().info("User logout successful", "webserver.cpp");
         
         // Record Prometheus metrics
         auto& metrics = MetricsRegistry::getInstance();
-        metrics.recordHttpRequest("GET", "/api/devices", 200, duration_ms / 1000.0);
-        metrics.recordDbOperation("get_devices", true);
+        metrics.recordHttpRequest("POST", "/api/logout", 200, 0.001);
+        metrics.recordDbOperation("logout", true);
+        
+        Logger::getInstance().logRequest(client_ip, "POST", "/api/logout", 200, 1);
+        
+        json response;
+        response["success"] = true;
+        response["message"] = "Logged out successfully";
         
         crow::response res(200);
         res.set_header("Content-Type", "application/json; charset=utf-8");
         res.set_header("Access-Control-Allow-Origin", "*");
-        res.body = result.dump();
+        res.body = response.dump();
         return res;
     });
     
+    // API: Получение устройств (?id=1,2&status=&search=&sort=id|name|model|purchase_date|status
+    // &order=asc|desc&limit=&offset=)
+    CROW_ROUTE(app, "/api/devices")
+    .methods("GET"_method)
+    ([this](const crow::request& req, crow::response& res) {
+        DeviceQuery query;
+        if (!parseDeviceQuery(req.url_params, query)) {
+            res = listRequestError("/api/devices",
+                                   "Expected id as comma-separated positive ids, non-empty status and search "
+                                   "(up to 100 characters), sort=id|name|model|purchase_date|status, "
+                                   "order=asc|desc, limit=1..10000 and offset >= 0");
+            res.end();
+            return;
+        }
+        
+        dispatchDb(req, res, [this, query = std::move(query)]() {
+            auto start_time = std::chrono::high_resolution_clock::now();
+            auto devices = db->getDeviceViews(query);
+            RequestDeadline::check("serialization");
+            std::pmr::string body = rowsToJson(devices, 96);
+        
+            auto end_time = std::chrono::high_resolution_clock::now();
+            long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+        
+            // Record Prometheus metrics
+            auto& metrics = MetricsRegistry::getInstance();
+            metrics.recordHttpRequest("GET", "/api/devices", 200, duration_ms / 1000.0);
+            metrics.recordDbOperation("get_devices", true);
+        
+            crow::response res(200);
+            res.set_header("Content-Type", "application/json; charset=utf-8");
+            res.set_header("Access-Control-Allow-Origin", "*");
+            res.body = responseBody(body);
+            return res;
+        });
+    });
+    
     // API: Добавление нового устройства (ЗАБЛОКИРОВАНО)
     CROW_ROUTE(app, "/api/devices")
     .methods("POST"_method)
@@ -328,153 +890,879 @@ void WebServer::setupRoutes() {
         return res;
     });
     
-    // API: Получение всех типов услуг
-    CROW_ROUTE(app, "/api/service-types")
+    // API: Устройство со статистикой обслуживания
+    CROW_ROUTE(app, "/api/devices/<int>")
     .methods("GET"_method)
-    ([this]() {
-        auto start_time = std::chrono::high_resolution_clock::now();
-        auto types = db->getAllServiceTypes();
-        json result = json::array();
+    ([this](const crow::request& req, crow::response& res, int id) {
+        dispatchDb(req, res, [this, id]() {
+            auto start_time = std::chrono::high_resolution_clock::now();
+            auto device = db->getDeviceDetails(id);
+            int status = device ? 200 : 404;
+            
+            json response;
+            if (device) {
+                response = std::move(*device);
+            } else {
+                response["success"] = false;
+                response["error"] = "Device not found";
+            }
+            
+            auto end_time = std::chrono::high_resolution_clock::now();
+            long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+            
+            // Record Prometheus metrics
+            auto& metrics = MetricsRegistry::getInstance();
+            metrics.recordHttpRequest("GET", "/api/devices/<id>", status, duration_ms / 1000.0);
+            metrics.recordDbOperation("get_device", true);
+            
+            crow::response res(status);
+            res.set_header("Content-Type", "application/json; charset=utf-8");
+            res.set_header("Access-Control-Allow-Origin", "*");
+            res.body = response.dump();
+            return res;
+        });
+    });
+    
+    // API: История обслуживания одного устройства (?limit=100&offset=0)
+    CROW_ROUTE(app, "/api/devices/<int>/history")
+    .methods("GET"_method)
+    ([this](const crow::request& req, crow::response& res, int id) {
+        int limit = DEFAULT_DEVICE_HISTORY_LIMIT;
+        int offset = 0;
+        bool valid = true;
+        if (const char* limit_param = req.url_params.get("limit")) {
+            valid = valid && parseInt(limit_param, 1, MAX_PAGE_SIZE, limit);
+        }
+        if (const char* offset_param = req.url_params.get("offset")) {
+            valid = valid && parseInt(offset_param, 0, std::numeric_limits<int>::max(), offset);
+        }
         
-        for (const auto& type : types) {
-            json j;
-            j["id"] = type.id;
-            j["name"] = type.name;
-            j["recommended_interval_months"] = type.recommended_interval_months;
-            j["standard_cost"] = type.standard_cost;
-            result.push_back(j);
+        if (!valid) {
+            res = listRequestError("/api/devices/<id>/history", "Expected limit=1..10000 and offset >= 0");
+            res.end();
+            return;
         }
         
-        auto end_time = std::chrono::high_resolution_clock::now();
-        long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+        dispatchDb(req, res, [this, id, limit, offset]() {
+            auto start_time = std::chrono::high_resolution_clock::now();
+            auto records = db->getDeviceHistory(id, limit, offset);
+            int status = records ? 200 : 404;
+            
+            json response;
+            if (records) {
+                response["device_id"] = id;
+                response["limit"] = limit;
+                response["offset"] = offset;
+                response["records"] = std::move(*records);
+            } else {
+                response["success"] = false;
+                response["error"] = "Device not found";
+            }
+            
+            auto end_time = std::chrono::high_resolution_clock::now();
+            long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+            
+            // Record Prometheus metrics
+            auto& metrics = MetricsRegistry::getInstance();
+            metrics.recordHttpRequest("GET", "/api/devices/<id>/history", status, duration_ms / 1000.0);
+            metrics.recordDbOperation("get_device_history", true);
+            
+            crow::response res(status);
+            res.set_header("Content-Type", "application/json; charset=utf-8");
+            res.set_header("Access-Control-Allow-Origin", "*");
+            res.body = response.dump();
+            return res;
+        });
+    });
+    
+    // API: Получение всех типов услуг
+    CROW_ROUTE(app, "/api/service-types")
+    .methods("GET"_method)
+    ([this](const crow::request& req, crow::response& res) {
+        dispatchDb(req, res, [this]() {
+            auto start_time = std::chrono::high_resolution_clock::now();
+            auto types = db->getServiceTypeViews();
+            std::pmr::string body = rowsToJson(types, 96);
         
-        // Record Prometheus metrics
-        auto& metrics = MetricsRegistry::getInstance();
-        metrics.recordHttpRequest("GET", "/api/service-types", 200, duration_ms / 1000.0);
-        metrics.recordDbOperation("get_service_types", true);
+            auto end_time = std::chrono::high_resolution_clock::now();
+            long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
         
-        crow::response res(200);
-        res.set_header("Content-Type", "application/json; charset=utf-8");
-        res.set_header("Access-Control-Allow-Origin", "*");
-        res.body = result.dump();
-        return res;
+            // Record Prometheus metrics
+            auto& metrics = MetricsRegistry::getInstance();
+            metrics.recordHttpRequest("GET", "/api/service-types", 200, duration_ms / 1000.0);
+            metrics.recordDbOperation("get_service_types", true);
+        
+            crow::response res(200);
+            res.set_header("Content-Type", "application/json; charset=utf-8");
+            res.set_header("Access-Control-Allow-Origin", "*");
+            res.body = responseBody(body);
+            return res;
+        });
     });
     
-    // API: Получение истории обслуживания (детализированная с JOIN)
+    // API: Получение истории обслуживания (детализированная с JOIN).
+    // Фильтры: device_id, service_id (списки через запятую), from/to, min_cost/max_cost, search;
+    // sort=date|id|cost|next_due_date|device|service, order, limit, offset
     CROW_ROUTE(app, "/api/service-history")
     .methods("GET"_method)
-    ([this]() {
-        auto start_time = std::chrono::high_resolution_clock::now();
-        auto history = db->getDetailedServiceHistory();
+    ([this](const crow::request& req, crow::response& res) {
+        HistoryQuery query;
+        if (!parseHistoryQuery(req.url_params, query)) {
+            res = listRequestError("/api/service-history",
+                                   "Expected device_id/service_id as comma-separated positive ids, from/to as "
+                                   "YYYY-MM-DD, non-negative min_cost/max_cost, search up to 100 characters, "
+                                   "sort=date|id|cost|next_due_date|device|service, order=asc|desc, "
+                                   "limit=1..10000 and offset >= 0");
+            res.end();
+            return;
+        }
         
-        auto end_time = std::chrono::high_resolution_clock::now();
-        long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+        dispatchDb(req, res, [this, query = std::move(query)]() {
+            auto start_time = std::chrono::high_resolution_clock::now();
+            auto history = db->getDetailedServiceHistory(query, RequestArena::resource());
+            RequestDeadline::check("serialization");
+            std::pmr::string body = rowsToJson(history.records, 224);
         
-        // Record Prometheus metrics
-        auto& metrics = MetricsRegistry::getInstance();
-        metrics.recordHttpRequest("GET", "/api/service-history", 200, duration_ms / 1000.0);
-        metrics.recordDbOperation("get_service_history", true);
+            auto end_time = std::chrono::high_resolution_clock::now();
+            long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
         
-        crow::response res(200);
-        res.set_header("Content-Type", "application/json; charset=utf-8");
-        res.set_header("Access-Control-Allow-Origin", "*");
-        res.body = history.dump();
-        return res;
+            // Record Prometheus metrics
+            auto& metrics = MetricsRegistry::getInstance();
+            metrics.recordHttpRequest("GET", "/api/service-history", 200, duration_ms / 1000.0);
+            metrics.recordDbOperation("get_service_history", true);
+        
+            crow::response res(200);
+            res.set_header("Content-Type", "application/json; charset=utf-8");
+            res.set_header("Access-Control-Allow-Origin", "*");
+            res.body = responseBody(body);
+            return res;
+        });
     });
     
     // API: Добавление записи обслуживания
     CROW_ROUTE(app, "/api/service-history")
     .methods("POST"_method)
-    ([this](const crow::request& req) {
-        auto start_time = std::chrono::high_resolution_clock::now();
-        int record_id = -1;
-        bool success = false;
+    ([this](const crow::request& req, crow::response& res) {
+        dispatchDb(req, res, [this, request_body = req.body]() {
+            auto start_time = std::chrono::high_resolution_clock::now();
         
+            try {
+                auto body = json::parse(request_body);
+                ServiceRecord record = serviceRecordFromJson(body);
+            
+                auto created = db->addServiceRecord(record);
+                bool success = created.has_value();
+                int record_id = success ? created->id : -1;
+            
+                // Record metrics
+                auto& metrics = MetricsRegistry::getInstance();
+                metrics.recordServiceOperation("create", record_id, success);
+                metrics.recordDbOperation("add_service_record", success);
+            
+                // Созданная запись возвращается целиком, повторно запрашивать список не нужно
+                json response;
+                response["success"] = success;
+                if (success) {
+                    response["record_id"] = record_id;
+                    response["record"] = serviceRecordToJson(*created);
+                } else {
+                    response["error"] = "Failed to add service record";
+                }
+            
+                int status = success ? 201 : 400;
+                auto end_time = std::chrono::high_resolution_clock::now();
+                long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+                metrics.recordHttpRequest("POST", "/api/service-history", status, duration_ms / 1000.0);
+            
+                crow::response res(status);
+                res.set_header("Content-Type", "application/json; charset=utf-8");
+                res.set_header("Access-Control-Allow-Origin", "*");
+                if (success) {
+                    res.set_header("Location", "/api/service-history/" + std::to_string(record_id));
+                }
+                res.body = response.dump();
+                return res;
+            } catch (const DeadlineExceeded&) {
+                // Ответ 504 формирует dispatchTo
+                throw;
+            } catch (const std::exception& e) {
+                auto end_time = std::chrono::high_resolution_clock::now();
+                long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+            
+                // Record metrics for error
+                auto& metrics = MetricsRegistry::getInstance();
+                metrics.recordServiceOperation("create", -1, false);
+                metrics.recordDbOperation("add_service_record", false);
+                metrics.recordHttpRequest("POST", "/api/service-history", 400, duration_ms / 1000.0);
+            
+                json response;
+                response["success"] = false;
+                response["error"] = e.what();
+            
+                crow::response res(400);
+                res.set_header("Content-Type", "application/json; charset=utf-8");
+                res.set_header("Access-Control-Allow-Origin", "*");
+                res.body = response.dump();
+                return res;
+            }
+        });
+    });
+    
+    // API: Получение одной записи обслуживания
+    CROW_ROUTE(app, "/api/service-history/<int>")
+    .methods("GET"_method)
+    ([this](const crow::request& req, crow::response& res, int id) {
+        dispatchDb(req, res, [this, id]() {
+            auto start_time = std::chrono::high_resolution_clock::now();
+            auto record = db->getServiceRecord(id);
+            int status = record ? 200 : 404;
+            
+            json response;
+            if (record) {
+                response = serviceRecordToJson(*record);
+            } else {
+                response["success"] = false;
+                response["error"] = "Service record not found";
+            }
+            
+            auto end_time = std::chrono::high_resolution_clock::now();
+            long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+            
+            // Record Prometheus metrics
+            auto& metrics = MetricsRegistry::getInstance();
+            metrics.recordHttpRequest("GET", "/api/service-history/<id>", status, duration_ms / 1000.0);
+            metrics.recordDbOperation("get_service_record", true);
+            
+            crow::response res(status);
+            res.set_header("Content-Type", "application/json; charset=utf-8");
+            res.set_header("Access-Control-Allow-Origin", "*");
+            res.body = response.dump();
+            return res;
+        });
+    });
+    
+    // API: Обновление записи обслуживания, в ответе — обновлённая запись
+    CROW_ROUTE(app, "/api/service-history/<int>")
+    .methods("PUT"_method)
+    ([this](const crow::request& req, crow::response& res, int id) {
+        ServiceRecord record;
         try {
-            auto body = json::parse(req.body);
-            ServiceRecord record;
-            record.device_id = body["device_id"].get<int>();
-            record.service_id = body["service_id"].get<int>();
-            record.service_date = body["service_date"].get<std::string>();
-            record.cost = body["cost"].get<double>();
-            record.notes = body["notes"].get<std::string>();
-            record.next_due_date = body["next_due_date"].get<std::string>();
-            
-            success = db->addServiceRecord(record);
-            record_id = success ? 1 : -1;
-            
-            // Record metrics
+            record = serviceRecordFromJson(json::parse(req.body));
+        } catch (const std::exception& e) {
+            MetricsRegistry::getInstance().recordHttpRequest("PUT", "/api/service-history/<id>", 400, 0.0);
+            
+            json response;
+            response["success"] = false;
+            response["error"] = e.what();
+            
+            res.code = 400;
+            res.set_header("Content-Type", "application/json; charset=utf-8");
+            res.set_header("Access-Control-Allow-Origin", "*");
+            res.body = response.dump();
+            res.end();
+            return;
+        }
+        
+        dispatchDb(req, res, [this, id, record = std::move(record)]() {
+            auto start_time = std::chrono::high_resolution_clock::now();
+            // 404 — только если записи нет; ошибка БД — 500
+            std::optional<ServiceRecord> updated;
+            std::string error;
+            try {
+                updated = db->updateServiceRecord(id, record);
+            } catch (const DeadlineExceeded&) {
+                throw;
+            } catch (const std::exception& e) {
+                error = e.what();
+            }
+            bool success = updated.has_value();
+            int status = success ? 200 : (error.empty() ? 404 : 500);
+            
+            json response;
+            response["success"] = success;
+            if (success) {
+                response["record"] = serviceRecordToJson(*updated);
+            } else {
+                response["error"] = error.empty() ? "Service record not found" : "Update failed: " + error;
+            }
+            
+            auto end_time = std::chrono::high_resolution_clock::now();
+            long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+            
+            // Record Prometheus metrics
             auto& metrics = MetricsRegistry::getInstance();
-            metrics.recordServiceOperation("create", record_id, success);
-            metrics.recordDbOperation("add_service_record", success);
+            metrics.recordServiceOperation("update", id, success);
+            metrics.recordDbOperation("update_service_record", error.empty());
+            metrics.recordHttpRequest("PUT", "/api/service-history/<id>", status, duration_ms / 1000.0);
+            
+            crow::response res(status);
+            res.set_header("Content-Type", "application/json; charset=utf-8");
+            res.set_header("Access-Control-Allow-Origin", "*");
+            res.body = response.dump();
+            return res;
+        });
+    });
+    
+    // API: Удаление записи обслуживания
+    CROW_ROUTE(app, "/api/service-history/<int>")
+    .methods("DELETE"_method)
+    ([this](const crow::request& req, crow::response& res, int id) {
+        dispatchDb(req, res, [this, id]() {
+            auto start_time = std::chrono::high_resolution_clock::now();
+            // 404 — только если записи нет; ошибка БД — 500
+            bool success = false;
+            std::string error;
+            try {
+                success = db->deleteServiceRecord(id);
+            } catch (const DeadlineExceeded&) {
+                throw;
+            } catch (const std::exception& e) {
+                error = e.what();
+            }
+            int status = success ? 200 : (error.empty() ? 404 : 500);
             
             json response;
             response["success"] = success;
+            response["record_id"] = id;
+            if (!success) {
+                response["error"] = error.empty() ? "Service record not found" : "Delete failed: " + error;
+            }
             
             auto end_time = std::chrono::high_resolution_clock::now();
             long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
-            metrics.recordHttpRequest("POST", "/api/service-history", success ? 200 : 400, duration_ms / 1000.0);
             
-            crow::response res;
+            // Record Prometheus metrics
+            auto& metrics = MetricsRegistry::getInstance();
+            metrics.recordServiceOperation("delete", id, success);
+            metrics.recordDbOperation("delete_service_record", error.empty());
+            metrics.recordHttpRequest("DELETE", "/api/service-history/<id>", status, duration_ms / 1000.0);
+            
+            crow::response res(status);
             res.set_header("Content-Type", "application/json; charset=utf-8");
             res.set_header("Access-Control-Allow-Origin", "*");
             res.body = response.dump();
             return res;
+        });
+    });
+    
+    // API: Пакетное создание записей обслуживания (JSON-массив записей)
+    CROW_ROUTE(app, "/api/service-history/batch")
+    .methods("POST"_method)
+    ([this](const crow::request& req, crow::response& res) {
+        std::vector<ServiceRecord> records;
+        try {
+            auto body = json::parse(req.body);
+            if (!body.is_array() || body.empty() || body.size() > MAX_BATCH_SIZE) {
+                throw std::invalid_argument("Expected a non-empty JSON array of at most " +
+                                            std::to_string(MAX_BATCH_SIZE) + " records");
+            }
+            for (const auto& item : body) {
+                records.push_back(serviceRecordFromJson(item));
+            }
+        } catch (const std::exception& e) {
+            res = batchRequestError("POST", e.what());
+            res.end();
+            return;
+        }
+        
+        dispatchDb(req, res, [this, records = std::move(records)]() {
+            auto start_time = std::chrono::high_resolution_clock::now();
+            BatchResult result = db->addServiceRecords(records);
+            return batchResponse("POST", "add_service_records", result, start_time);
+        });
+    });
+    
+    // API: Пакетное обновление записей обслуживания (JSON-массив записей с полем id)
+    CROW_ROUTE(app, "/api/service-history/batch")
+    .methods("PUT"_method)
+    ([this](const crow::request& req, crow::response& res) {
+        std::vector<ServiceRecord> records;
+        try {
+            auto body = json::parse(req.body);
+            if (!body.is_array() || body.empty() || body.size() > MAX_BATCH_SIZE) {
+                throw std::invalid_argument("Expected a non-empty JSON array of at most " +
+                                            std::to_string(MAX_BATCH_SIZE) + " records");
+            }
+            for (const auto& item : body) {
+                ServiceRecord record = serviceRecordFromJson(item);
+                if (record.id <= 0) {
+                    throw std::invalid_argument("Every record must have a positive id");
+                }
+                records.push_back(std::move(record));
+            }
         } catch (const std::exception& e) {
+            res = batchRequestError("PUT", e.what());
+            res.end();
+            return;
+        }
+        
+        dispatchDb(req, res, [this, records = std::move(records)]() {
+            auto start_time = std::chrono::high_resolution_clock::now();
+            BatchResult result = db->updateServiceRecords(records);
+            return batchResponse("PUT", "update_service_records", result, start_time);
+        });
+    });
+    
+    // API: Пакетное удаление записей обслуживания (JSON-массив record_id)
+    CROW_ROUTE(app, "/api/service-history/batch")
+    .methods("DELETE"_method)
+    ([this](const crow::request& req, crow::response& res) {
+        std::vector<int> ids;
+        try {
+            auto body = json::parse(req.body);
+            if (!body.is_array() || body.empty() || body.size() > MAX_BATCH_SIZE) {
+                throw std::invalid_argument("Expected a non-empty JSON array of at most " +
+                                            std::to_string(MAX_BATCH_SIZE) + " record ids");
+            }
+            ids = body.get<std::vector<int>>();
+        } catch (const std::exception& e) {
+            res = batchRequestError("DELETE", e.what());
+            res.end();
+            return;
+        }
+        
+        dispatchDb(req, res, [this, ids = std::move(ids)]() {
+            auto start_time = std::chrono::high_resolution_clock::now();
+            BatchResult result = db->deleteServiceRecords(ids);
+            return batchResponse("DELETE", "delete_service_records", result, start_time);
+        });
+    });
+    
+    // API: Массовый импорт истории обслуживания (NDJSON или CSV) через COPY
+    CROW_ROUTE(app, "/api/import/service-history")
+    .methods("POST"_method)
+    ([this](const crow::request& req, crow::response& res) {
+        std::string format = "ndjson";
+        if (const char* format_param = req.url_params.get("format")) {
+            format = format_param;
+        } else if (req.get_header_value("Content-Type").find("csv") != std::string::npos) {
+            format = "csv";
+        }
+        const char* atomic_param = req.url_params.get("atomic");
+        bool atomic = atomic_param && std::string(atomic_param) == "true";
+        
+        dispatchDb(req, res, [this, request_body = req.body, format, atomic]() {
+            auto start_time = std::chrono::high_resolution_clock::now();
+            
+            std::vector<ImportRow> rows;
+            std::vector<ImportRowError> parse_errors;
+            if (format == "csv") {
+                service_import::parseCsv(request_body, rows, parse_errors);
+            } else {
+                service_import::parseNdjson(request_body, rows, parse_errors);
+            }
+            
+            ImportResult result;
+            if (!rows.empty() && !(atomic && !parse_errors.empty())) {
+                result = db->importServiceRecords(rows, atomic);
+            }
+            result.total_rows = rows.size() + parse_errors.size();
+            result.errors.insert(result.errors.end(), parse_errors.begin(), parse_errors.end());
+            std::sort(result.errors.begin(), result.errors.end(),
+                      [](const ImportRowError& a, const ImportRowError& b) { return a.line < b.line; });
+            
+            // Ограничиваем размер ответа при большом числе ошибочных строк
+            const size_t max_reported_errors = 1000;
+            json errors = json::array();
+            for (size_t i = 0; i < result.errors.size() && i < max_reported_errors; ++i) {
+                errors.push_back({{"line", result.errors[i].line}, {"error", result.errors[i].error}});
+            }
+            
+            json response;
+            response["success"] = result.committed && result.errors.empty();
+            response["committed"] = result.committed;
+            response["total_rows"] = result.total_rows;
+            response["imported"] = result.imported;
+            response["failed"] = result.errors.size();
+            response["errors"] = errors;
+            response["errors_truncated"] = result.errors.size() > max_reported_errors;
+            
+            int status = result.committed ? 200 : 400;
+            
             auto end_time = std::chrono::high_resolution_clock::now();
             long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
             
-            // Record metrics for error
+            // Record Prometheus metrics
             auto& metrics = MetricsRegistry::getInstance();
-            metrics.recordServiceOperation("create", -1, false);
-            metrics.recordDbOperation("add_service_record", false);
-            metrics.recordHttpRequest("POST", "/api/service-history", 400, duration_ms / 1000.0);
+            metrics.recordHttpRequest("POST", "/api/import/service-history", status, duration_ms / 1000.0);
+            metrics.recordDbOperation("import_service_records", result.committed);
+            
+            Logger::getInstance().info("Service history import: " + std::to_string(result.imported) + " of " +
+                                       std::to_string(result.total_rows) + " rows imported", "webserver.cpp");
+            
+            crow::response res(status);
+            res.set_header("Content-Type", "application/json; charset=utf-8");
+            res.set_header("Access-Control-Allow-Origin", "*");
+            res.body = response.dump();
+            return res;
+        });
+    });
+    
+    // API: Выгрузка истории обслуживания (CSV или NDJSON) через COPY TO STDOUT
+    CROW_ROUTE(app, "/api/export/service-history")
+    .methods("GET"_method)
+    ([this](const crow::request& req, crow::response& res) {
+        const char* format_param = req.url_params.get("format");
+        const char* from_param = req.url_params.get("from");
+        const char* to_param = req.url_params.get("to");
+        const char* after_id_param = req.url_params.get("after_id");
+        const char* limit_param = req.url_params.get("limit");
+        std::string format = format_param ? format_param : "csv";
+        std::string from = from_param ? from_param : "";
+        std::string to = to_param ? to_param : "";
+        int after_id = 0;
+        int limit = MAX_EXPORT_PAGE_SIZE;
+        
+        bool valid = (format == "csv" || format == "ndjson") &&
+                     (from.empty() || service_import::isValidDate(from)) &&
+                     (to.empty() || service_import::isValidDate(to));
+        if (after_id_param) {
+            valid = valid && parseInt(after_id_param, 0, std::numeric_limits<int32_t>::max(), after_id);
+        }
+        if (limit_param) {
+            valid = valid && parseInt(limit_param, 1, MAX_EXPORT_PAGE_SIZE, limit);
+        }
+        if (!valid) {
+            MetricsRegistry::getInstance().recordHttpRequest("GET", "/api/export/service-history", 400, 0.0);
             
             json response;
             response["success"] = false;
-            response["error"] = e.what();
+            response["error"] = "Expected format=csv|ndjson, from/to as YYYY-MM-DD, after_id >= 0 and limit 1-" +
+                                std::to_string(MAX_EXPORT_PAGE_SIZE);
             
-            crow::response res(400);
+            res.code = 400;
             res.set_header("Content-Type", "application/json; charset=utf-8");
             res.set_header("Access-Control-Allow-Origin", "*");
             res.body = response.dump();
+            res.end();
+            return;
+        }
+        
+        dispatchDb(req, res, [this, format, from, to, after_id, limit]() {
+            auto start_time = std::chrono::high_resolution_clock::now();
+            bool csv = format == "csv";
+            
+            // Строки COPY форматируются прямо в тело ответа
+            crow::response res(200);
+            if (csv) {
+                service_export::appendCsvHeader(res.body);
+            }
+            ExportResult result = db->exportServiceRecords(from, to, after_id, static_cast<size_t>(limit),
+                                                           [&res, csv](const std::vector<pqxx::zview>& fields) {
+                if (csv) {
+                    service_export::appendCsvRow(res.body, fields);
+                } else {
+                    service_export::appendNdjsonRow(res.body, fields);
+                }
+            });
+            int status = result.success ? 200 : 500;
+            
+            auto end_time = std::chrono::high_resolution_clock::now();
+            long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+            
+            // Record Prometheus metrics
+            auto& metrics = MetricsRegistry::getInstance();
+            metrics.recordHttpRequest("GET", "/api/export/service-history", status, duration_ms / 1000.0);
+            metrics.recordDbOperation("export_service_records", result.success);
+            
+            if (!result.success) {
+                json response;
+                response["success"] = false;
+                response["error"] = "Export failed";
+                
+                crow::response error_res(status);
+                error_res.set_header("Content-Type", "application/json; charset=utf-8");
+                error_res.set_header("Access-Control-Allow-Origin", "*");
+                error_res.body = response.dump();
+                return error_res;
+            }
+            
+            res.set_header("Content-Type", csv ? "text/csv; charset=utf-8" : "application/x-ndjson; charset=utf-8");
+            res.set_header("Content-Disposition", std::string("attachment; filename=\"service_history.") +
+                                                  (csv ? "csv" : "ndjson") + "\"");
+            // Следующая страница: тот же запрос с after_id из заголовка; без заголовка — строк больше нет
+            if (result.has_more) {
+                res.set_header("X-Next-After-Id", std::to_string(result.last_id));
+            }
+            res.set_header("Access-Control-Expose-Headers", "X-Next-After-Id");
+            res.set_header("Access-Control-Allow-Origin", "*");
             return res;
+        });
+    });
+    
+    // API: Просроченное обслуживание
+    CROW_ROUTE(app, "/api/maintenance/overdue")
+    .methods("GET"_method)
+    ([this](const crow::request& req, crow::response& res) {
+        dispatchDb(req, res, [this]() {
+            auto start_time = std::chrono::high_resolution_clock::now();
+            json result = db->getOverdueMaintenance();
+            
+            auto end_time = std::chrono::high_resolution_clock::now();
+            long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+            
+            // Record Prometheus metrics
+            auto& metrics = MetricsRegistry::getInstance();
+            metrics.recordHttpRequest("GET", "/api/maintenance/overdue", 200, duration_ms / 1000.0);
+            metrics.recordDbOperation("get_overdue_maintenance", true);
+            
+            crow::response res(200);
+            res.set_header("Content-Type", "application/json; charset=utf-8");
+            res.set_header("Access-Control-Allow-Origin", "*");
+            res.body = result.dump();
+            return res;
+        });
+    });
+    
+    // API: Ближайшее плановое обслуживание (?days=N, по умолчанию 30)
+    CROW_ROUTE(app, "/api/maintenance/upcoming")
+    .methods("GET"_method)
+    ([this](const crow::request& req, crow::response& res) {
+        int days = 30;
+        const char* days_param = req.url_params.get("days");
+        if (days_param && !parseInt(days_param, 1, MAX_UPCOMING_DAYS, days)) {
+            res = listRequestError("/api/maintenance/upcoming",
+                                   "days must be an integer from 1 to " + std::to_string(MAX_UPCOMING_DAYS));
+            res.end();
+            return;
         }
+        
+        dispatchDb(req, res, [this, days]() {
+            auto start_time = std::chrono::high_resolution_clock::now();
+            json result = db->getUpcomingMaintenance(days);
+            
+            auto end_time = std::chrono::high_resolution_clock::now();
+            long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+            
+            // Record Prometheus metrics
+            auto& metrics = MetricsRegistry::getInstance();
+            metrics.recordHttpRequest("GET", "/api/maintenance/upcoming", 200, duration_ms / 1000.0);
+            metrics.recordDbOperation("get_upcoming_maintenance", true);
+            
+            crow::response res(200);
+            res.set_header("Content-Type", "application/json; charset=utf-8");
+            res.set_header("Access-Control-Allow-Origin", "*");
+            res.body = result.dump();
+            return res;
+        });
     });
     
-    // API: Получение всех записей обслуживания (простой вариант)
-    CROW_ROUTE(app, "/api/service-records")
+    // API: Статистика затрат по устройствам
+    CROW_ROUTE(app, "/api/stats/devices")
     .methods("GET"_method)
-    ([this]() {
-        auto start_time = std::chrono::high_resolution_clock::now();
-        auto records = db->getAllServiceRecords();
-        json result = json::array();
+    ([this](const crow::request& req, crow::response& res) {
+        dispatchDb(req, res, [this]() {
+            auto start_time = std::chrono::high_resolution_clock::now();
+            auto result = db->getDeviceStats();
+            
+            auto end_time = std::chrono::high_resolution_clock::now();
+            long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+            
+            // Record Prometheus metrics
+            auto& metrics = MetricsRegistry::getInstance();
+            metrics.recordHttpRequest("GET", "/api/stats/devices", result ? 200 : 500, duration_ms / 1000.0);
+            metrics.recordDbOperation("get_device_stats", result.has_value());
+            
+            // Ошибка запроса (например, нет таблицы Device_Stats) — не пустой список, а 500
+            if (!result) {
+                json response;
+                response["success"] = false;
+                response["error"] = "Failed to load device stats";
+                
+                crow::response error_res(500);
+                error_res.set_header("Content-Type", "application/json; charset=utf-8");
+                error_res.set_header("Access-Control-Allow-Origin", "*");
+                error_res.body = response.dump();
+                return error_res;
+            }
+            
+            crow::response res(200);
+            res.set_header("Content-Type", "application/json; charset=utf-8");
+            res.set_header("Access-Control-Allow-Origin", "*");
+            res.body = result->dump();
+            return res;
+        });
+    });
+    
+    // API: Поиск по устройствам и заметкам обслуживания (?q=текст&limit=20&offset=0)
+    CROW_ROUTE(app, "/api/search")
+    .methods("GET"_method)
+    ([this](const crow::request& req, crow::response& res) {
+        const char* q_param = req.url_params.get("q");
+        std::string text = q_param ? q_param : "";
+        int limit = DEFAULT_SEARCH_LIMIT;
+        int offset = 0;
         
-        for (const auto& record : records) {
-            json j;
-            j["id"] = record.id;
-            j["device_id"] = record.device_id;
-            j["service_id"] = record.service_id;
-            j["service_date"] = record.service_date;
-            j["cost"] = record.cost;
-            j["notes"] = record.notes;
-            j["next_due_date"] = record.next_due_date;
-            result.push_back(j);
+        bool valid = utf8Length(text) >= MIN_QUERY_CHARS && text.size() <= MAX_SEARCH_LENGTH;
+        if (const char* limit_param = req.url_params.get("limit")) {
+            valid = valid && parseInt(limit_param, 1, MAX_SEARCH_LIMIT, limit);
+        }
+        if (const char* offset_param = req.url_params.get("offset")) {
+            valid = valid && parseInt(offset_param, 0, std::numeric_limits<int>::max(), offset);
         }
         
-        auto end_time = std::chrono::high_resolution_clock::now();
-        long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+        if (!valid) {
+            res = listRequestError("/api/search",
+                                   "Expected q with 3 to 100 characters, limit=1..100 and offset >= 0");
+            res.end();
+            return;
+        }
         
-        // Record Prometheus metrics
+        dispatchDb(req, res, [this, text, limit, offset]() {
+            auto start_time = std::chrono::high_resolution_clock::now();
+            json response = db->search(text, limit, offset);
+            response["query"] = text;
+            response["limit"] = limit;
+            response["offset"] = offset;
+            
+            auto end_time = std::chrono::high_resolution_clock::now();
+            long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+            
+            // Record Prometheus metrics
+            auto& metrics = MetricsRegistry::getInstance();
+            metrics.recordHttpRequest("GET", "/api/search", 200, duration_ms / 1000.0);
+            metrics.recordDbOperation("search", true);
+            
+            crow::response res(200);
+            res.set_header("Content-Type", "application/json; charset=utf-8");
+            res.set_header("Access-Control-Allow-Origin", "*");
+            res.body = response.dump();
+            return res;
+        });
+    });
+    
+    // API: Агрегаты по колоночной копии истории в памяти (?group_by=device|service|month&from=&to=&device_id=&service_id=)
+    CROW_ROUTE(app, "/api/analytics")
+    .methods("GET"_method)
+    ([this](const crow::request& req, crow::response& res) {
+        auto start_time = std::chrono::high_resolution_clock::now();
         auto& metrics = MetricsRegistry::getInstance();
-        metrics.recordHttpRequest("GET", "/api/service-records", 200, duration_ms / 1000.0);
-        metrics.recordDbOperation("get_service_records", true);
         
-        crow::response res(200);
         res.set_header("Content-Type", "application/json; charset=utf-8");
         res.set_header("Access-Control-Allow-Origin", "*");
-        res.body = result.dump();
-        return res;
+        
+        if (!analytics || !analytics->ready()) {
+            metrics.recordHttpRequest("GET", "/api/analytics", 503, 0.0);
+            
+            json response;
+            response["success"] = false;
+            response["error"] = analytics ? "Analytics snapshot is loading" : "Analytics is disabled";
+            
+            res.code = 503;
+            res.body = response.dump();
+            res.end();
+            return;
+        }
+        
+        const char* group_param = req.url_params.get("group_by");
+        std::string group_by = group_param ? group_param : "device";
+        AnalyticsStore::GroupBy grouping = AnalyticsStore::GroupBy::Device;
+        bool valid = true;
+        if (group_by == "service") {
+            grouping = AnalyticsStore::GroupBy::ServiceType;
+        } else if (group_by == "month") {
+            grouping = AnalyticsStore::GroupBy::Month;
+        } else if (group_by != "device") {
+            valid = false;
+        }
+        
+        AnalyticsStore::Filter filter;
+        if (const char* from_param = req.url_params.get("from")) {
+            auto day = Date::parse(from_param);
+            valid = valid && day.has_value();
+            filter.from_day = day ? day->days() : filter.from_day;
+        }
+        if (const char* to_param = req.url_params.get("to")) {
+            auto day = Date::parse(to_param);
+            valid = valid && day.has_value();
+            filter.to_day = day ? day->days() : filter.to_day;
+        }
+        if (const char* device_param = req.url_params.get("device_id")) {
+            valid = valid && parseIdList(device_param, filter.device_ids);
+        }
+        if (const char* service_param = req.url_params.get("service_id")) {
+            valid = valid && parseIdList(service_param, filter.service_ids);
+        }
+        
+        if (!valid) {
+            metrics.recordHttpRequest("GET", "/api/analytics", 400, 0.0);
+            
+            json response;
+            response["success"] = false;
+            response["error"] = "Expected group_by=device|service|month, from/to as YYYY-MM-DD "
+                                "and comma-separated positive device_id/service_id";
+            
+            res.code = 400;
+            res.body = response.dump();
+            res.end();
+            return;
+        }
+        
+        // Агрегация выполняется в памяти без обращения к БД, поэтому прямо в I/O потоке
+        json groups = json::array();
+        for (const auto& group : analytics->aggregate(grouping, filter)) {
+            json item;
+            if (grouping == AnalyticsStore::GroupBy::Month) {
+                item["month"] = AnalyticsStore::formatMonth(group.key);
+            } else {
+                item[grouping == AnalyticsStore::GroupBy::Device ? "device_id" : "service_id"] = group.key;
+            }
+            item["count"] = group.count;
+            item["total_cost"] = Money::fromCents(group.total_cents);
+            item["min_cost"] = Money::fromCents(group.min_cents);
+            item["max_cost"] = Money::fromCents(group.max_cents);
+            item["avg_cost"] = static_cast<double>(group.total_cents) / group.count / 100.0;
+            groups.push_back(item);
+        }
+        
+        simd_kernels::CostStats stats = analytics->totals(filter);
+        json totals;
+        totals["count"] = stats.count;
+        totals["total_cost"] = Money::fromCents(stats.sum);
+        totals["min_cost"] = stats.count ? json(Money::fromCents(stats.min)) : json(nullptr);
+        totals["max_cost"] = stats.count ? json(Money::fromCents(stats.max)) : json(nullptr);
+        
+        json response;
+        response["group_by"] = group_by;
+        response["groups"] = groups;
+        response["totals"] = totals;
+        response["overdue_count"] = analytics->overdueCount(Date::today().days());
+        response["row_count"] = analytics->rowCount();
+        
+        auto end_time = std::chrono::high_resolution_clock::now();
+        long duration_us = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+        response["elapsed_us"] = duration_us;
+        
+        metrics.recordHttpRequest("GET", "/api/analytics", 200, duration_us / 1000000.0);
+        
+        res.code = 200;
+        res.body = response.dump();
+        res.end();
+    });
+    
+    // API: Получение всех записей обслуживания (простой вариант)
+    CROW_ROUTE(app, "/api/service-records")
+    .methods("GET"_method)
+    ([this](const crow::request& req, crow::response& res) {
+        dispatchDb(req, res, [this]() {
+            auto start_time = std::chrono::high_resolution_clock::now();
+            auto records = db->getServiceRecordViews();
+            std::pmr::string body = rowsToJson(records, 160);
+        
+            auto end_time = std::chrono::high_resolution_clock::now();
+            long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+        
+            // Record Prometheus metrics
+            auto& metrics = MetricsRegistry::getInstance();
+            metrics.recordHttpRequest("GET", "/api/service-records", 200, duration_ms / 1000.0);
+            metrics.recordDbOperation("get_service_records", true);
+        
+            crow::response res(200);
+            res.set_header("Content-Type", "application/json; charset=utf-8");
+            res.set_header("Access-Control-Allow-Origin", "*");
+            res.body = responseBody(body);
+            return res;
+        });
     });
 }
 
@@ -2,20 +2,66 @@
 #include "database.h"
 #include "logger.h"
 #include "metrics.h"
+#include "db_executor.h"
+#include "analytics.h"
+#include "auth_middleware.h"
+#include "concurrency_limiter.h"
+#include "db_task.h"
+#include "login_throttle.h"
+#include "rate_limit_middleware.h"
+#include "request_deadline.h"
 #include <crow.h>
 #include <cfloat>
 #include <string>
 #include <memory>
+#include <functional>
+#include <chrono>
+#include <optional>
+#include <vector>
 
 class WebServer {
 private:
     std::unique_ptr<Database> db;
-    crow::SimpleApp app;
+    std::unique_ptr<DbExecutor> db_executor;
+    std::unique_ptr<AnalyticsStore> analytics;
+    crow::App<AuthMiddleware, RateLimitMiddleware> app;
     int port;
     
+    // Вход: поиск пользователя и PBKDF2 выполняются в отдельном пуле (auth.kdf_threads),
+    // чтобы не занимать I/O потоки и потоки запросов к БД
+    std::unique_ptr<DbExecutor> auth_executor;
+    std::shared_ptr<auth::TokenSigner> token_signer;
+    std::chrono::seconds token_ttl{3600};
+    int pbkdf2_iterations = 310000;
+    // Хеш для несуществующих пользователей: проверка занимает то же время, что и для реальных
+    std::string dummy_password_hash;
+    // Скользящие окна попыток входа по IP и имени пользователя (auth.login_throttle)
+    std::unique_ptr<LoginThrottle> login_throttle;
+    // Адаптивный лимит одновременных запросов к БД (database.concurrency_limit);
+    // nullptr — без ограничения
+    std::unique_ptr<ConcurrencyLimiter> db_limiter;
+    
+    // Сроки выполнения запросов к БД (deadlines): первый совпавший префикс пути,
+    // иначе default_deadline; 0 — без срока
+    struct RouteDeadline {
+        std::string prefix;
+        std::chrono::milliseconds timeout;
+    };
+    std::vector<RouteDeadline> route_deadlines;
+    std::chrono::milliseconds default_deadline{0};
+    
     void setupRoutes();
     std::string readConfig();
     
+    // Срок запроса к пути path, отсчитанный от текущего момента; nullopt — без срока
+    std::optional<RequestDeadline::Clock::time_point> deadlineFor(const std::string& path) const;
+    
+    // Выполняет work в пуле DbExecutor и завершает асинхронный ответ Crow;
+    // срок запроса определяется по пути req
+    void dispatchDb(const crow::request& req, crow::response& res, std::function<crow::response()> work);
+    void dispatchTo(DbExecutor& executor, crow::response& res, std::function<crow::response()> work,
+                    std::optional<RequestDeadline::Clock::time_point> deadline = std::nullopt);
+    
 public:
     WebServer(const std::string& config_file);
     void run();
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include "auth.h"
+#include <string>
+
+// Тесты токенов и хешей паролей: подпись, срок действия, подмена полей,
+// совместимость с хешами из insert_db.sql
+namespace {
+    // Меньше итераций, чем в конфигурации: тесты проверяют формат, а не стоимость
+    const int TEST_ITERATIONS = 1000;
+}
+
+TEST(TokenSignerTest, IssuedTokenVerifies) {
+    auth::TokenSigner signer("test-secret");
+    std::string token = signer.issue("admin", "admin", std::chrono::seconds(60));
+
+    auto claims = signer.verify(token, auth::unixNow());
+    ASSERT_TRUE(claims.has_value());
+    EXPECT_EQ(claims->username, "admin");
+    EXPECT_EQ(claims->role, "admin");
+}
+
+TEST(TokenSignerTest, ExpiredTokenIsRejected) {
+    auth::TokenSigner signer("test-secret");
+    std::string token = signer.issue("user", "user", std::chrono::seconds(60));
+
+    EXPECT_FALSE(signer.verify(token, auth::unixNow() + 61).has_value());
+}
+
+TEST(TokenSignerTest, OtherSecretIsRejected) {
+    auth::TokenSigner signer("test-secret");
+    auth::TokenSigner other("other-secret");
+    std::string token = signer.issue("user", "user", std::chrono::seconds(60));
+
+    EXPECT_FALSE(other.verify(token, auth::unixNow()).has_value());
+}
+
+TEST(TokenSignerTest, TamperedTokenIsRejected) {
+    auth::TokenSigner signer("test-secret");
+    std::string token = signer.issue("user", "user", std::chrono::seconds(60));
+
+    std::string tampered = token;
+    tampered[0] = tampered[0] == 'A' ? 'B' : 'A';
+    EXPECT_FALSE(signer.verify(tampered, auth::unixNow()).has_value());
+    EXPECT_FALSE(signer.verify(token.substr(0, token.find('.')), auth::unixNow()).has_value());
+    EXPECT_FALSE(signer.verify("", auth::unixNow()).has_value());
+}
+
+TEST(TokenCacheTest, ExpiredEntryIsEvicted) {
+    auth::TokenCache cache(2);
+    auth::Claims claims{"user", "user", 100};
+    cache.insert("token", claims, 50);
+
+    EXPECT_TRUE(cache.find("token", 99).has_value());
+    EXPECT_FALSE(cache.find("token", 100).has_value());
+}
+
+TEST(TokenCacheTest, CapacityIsBounded) {
+    auth::TokenCache cache(2);
+    cache.insert("a", auth::Claims{"a", "user", 1000}, 0);
+    cache.insert("b", auth::Claims{"b", "user", 1000}, 0);
+    cache.insert("c", auth::Claims{"c", "user", 1000}, 0);
+
+    int found = cache.find("a", 0).has_value() + cache.find("b", 0).has_value() + cache.find("c", 0).has_value();
+    EXPECT_EQ(found, 2);
+    EXPECT_TRUE(cache.find("c", 0).has_value());
+}
+
+TEST(PasswordHashTest, RoundTrip) {
+    std::string hash = auth::hashPassword("secret", TEST_ITERATIONS);
+
+    EXPECT_EQ(auth::hashIterations(hash), TEST_ITERATIONS);
+    EXPECT_TRUE(auth::verifyPassword("secret", hash));
+    EXPECT_FALSE(auth::verifyPassword("Secret", hash));
+}
+
+TEST(PasswordHashTest, SaltDiffersBetweenHashes) {
+    EXPECT_NE(auth::hashPassword("secret", TEST_ITERATIONS), auth::hashPassword("secret", TEST_ITERATIONS));
+}
+
+TEST(PasswordHashTest, MalformedHashIsRejected) {
+    EXPECT_FALSE(auth::verifyPassword("admin123", ""));
+    EXPECT_FALSE(auth::verifyPassword("admin123", "admin123"));
+    EXPECT_FALSE(auth::verifyPassword("admin123", "pbkdf2_sha256$x$abc$def"));
+    EXPECT_EQ(auth::hashIterations("md5$1$a$b"), 0);
+}
+
+TEST(PasswordHashTest, SeedHashesMatch) {
+    EXPECT_TRUE(auth::verifyPassword("admin123",
+        "pbkdf2_sha256$310000$QTIVEmZTTr0k2MbKZ4AaZw$yTkMTcvecsV3rJBp7t9EhG3a6WJ-DxAw7tmV82NfBW4"));
+    EXPECT_TRUE(auth::verifyPassword("user123",
+        "pbkdf2_sha256$310000$huai4EgeVpKYhDmSB_A8KQ$O49lk9ZufE4MQbdHv2idsne7rQQfA_S5A8YwDRU3HSs"));
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include "concurrency_limiter.h"
+#include "db_task.h"
+
+// Тесты адаптивного лимита (AIMD): отказ сверх лимита, мультипликативное снижение
+// на медленных ответах (одно на волну), аддитивный рост под нагрузкой, границы
+namespace {
+    using Clock = ConcurrencyLimiter::Clock;
+    using std::chrono::milliseconds;
+
+    ConcurrencyLimiter::Settings testSettings() {
+        ConcurrencyLimiter::Settings settings;
+        settings.initial_limit = 4.0;
+        settings.min_limit = 2.0;
+        settings.max_limit = 5.0;
+        settings.latency_threshold = milliseconds(100);
+        settings.backoff_ratio = 0.5;
+        return settings;
+    }
+}
+
+TEST(ConcurrencyLimiterTest, RejectsAboveLimit) {
+    ConcurrencyLimiter limiter(testSettings());
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(limiter.tryAcquire());
+    }
+    EXPECT_FALSE(limiter.tryAcquire());
+    EXPECT_EQ(limiter.inFlight(), 4);
+
+    auto now = Clock::now();
+    limiter.release(now, now);
+    EXPECT_TRUE(limiter.tryAcquire());
+}
+
+TEST(ConcurrencyLimiterTest, SlowResponsesDecreaseOncePerWave) {
+    ConcurrencyLimiter limiter(testSettings());
+    auto start = Clock::now();
+    for (int i = 0; i < 4; ++i) {
+        limiter.tryAcquire();
+    }
+
+    // Все четыре запроса допущены до снижения — лимит уменьшается один раз
+    for (int i = 0; i < 4; ++i) {
+        limiter.release(start, start + milliseconds(500));
+    }
+    EXPECT_DOUBLE_EQ(limiter.limit(), 2.0);
+
+    // Нижняя граница
+    limiter.tryAcquire();
+    limiter.release(start + milliseconds(600), start + milliseconds(900));
+    EXPECT_DOUBLE_EQ(limiter.limit(), 2.0);
+}
+
+TEST(ConcurrencyLimiterTest, FastResponsesUnderLoadIncrease) {
+    ConcurrencyLimiter limiter(testSettings());
+    auto now = Clock::now();
+
+    // Без нагрузки лимит не растёт
+    limiter.tryAcquire();
+    limiter.release(now, now + milliseconds(10));
+    EXPECT_DOUBLE_EQ(limiter.limit(), 4.0);
+
+    for (int round = 0; round < 50; ++round) {
+        while (limiter.tryAcquire()) {
+        }
+        limiter.release(now, now + milliseconds(10));
+    }
+    EXPECT_DOUBLE_EQ(limiter.limit(), 5.0);
+}
+
+TEST(ConcurrencyLimiterTest, PermitReleasesSlot) {
+    ConcurrencyLimiter limiter(testSettings());
+    ASSERT_TRUE(limiter.tryAcquire());
+    {
+        ConcurrencyLimiter::Permit permit(limiter, Clock::now());
+        EXPECT_EQ(limiter.inFlight(), 1);
+    }
+    EXPECT_EQ(limiter.inFlight(), 0);
+}
+
+TEST(ConcurrencyLimiterTest, QueueTimeoutReleasesSlot) {
+    ConcurrencyLimiter limiter(testSettings());
+    ASSERT_TRUE(limiter.tryAcquire());
+    bool called = false;
+    auto task = admitDbTask<int>([&called] { called = true; return 1; }, &limiter, Clock::now());
+
+    // Срок истёк, пока задача ждала в очереди пула: work не выполняется, слот возвращается
+    {
+        RequestDeadline::Scope scope(Clock::now() - milliseconds(1));
+        EXPECT_THROW(task(), DeadlineExceeded);
+    }
+    EXPECT_FALSE(called);
+    EXPECT_EQ(limiter.inFlight(), 0);
+}
+
+TEST(ConcurrencyLimiterTest, TaskReleasesSlotOnException) {
+    ConcurrencyLimiter limiter(testSettings());
+    ASSERT_TRUE(limiter.tryAcquire());
+    auto task = admitDbTask<int>([]() -> int { throw std::runtime_error("db error"); }, &limiter, Clock::now());
+
+    EXPECT_THROW(task(), std::runtime_error);
+    EXPECT_EQ(limiter.inFlight(), 0);
+}
+
+TEST(ConcurrencyLimiterTest, RejectsInvalidSettings) {
+    auto settings = testSettings();
+    settings.backoff_ratio = 1.5;
+    EXPECT_THROW(ConcurrencyLimiter{settings}, std::invalid_argument);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include "date.h"
+
+// Тесты Date: календарная проверка при разборе, формат YYYY-MM-DD, addMonths,
+// JSON и преобразования pqxx (текстовый формат PostgreSQL)
+namespace {
+    Date parsed(std::string_view text) {
+        auto date = Date::parse(text);
+        EXPECT_TRUE(date.has_value()) << text;
+        return date.value_or(Date());
+    }
+}
+
+TEST(DateTest, ParsesValidDates) {
+    EXPECT_EQ(parsed("1970-01-01").days(), 0);
+    EXPECT_EQ(parsed("1970-01-02").days(), 1);
+    EXPECT_EQ(parsed("1969-12-31").days(), -1);
+    EXPECT_EQ(parsed("2000-01-01").days(), 10957);
+}
+
+TEST(DateTest, RejectsNonexistentDays) {
+    EXPECT_FALSE(Date::parse("2023-02-30"));
+    EXPECT_FALSE(Date::parse("2024-02-30"));
+    EXPECT_FALSE(Date::parse("2024-04-31"));
+    EXPECT_FALSE(Date::parse("2024-13-01"));
+    EXPECT_FALSE(Date::parse("2024-00-10"));
+    EXPECT_FALSE(Date::parse("2024-01-00"));
+    EXPECT_FALSE(Date::parse("2024-01-32"));
+}
+
+TEST(DateTest, RejectsMalformedText) {
+    EXPECT_FALSE(Date::parse(""));
+    EXPECT_FALSE(Date::parse("2024-1-01"));
+    EXPECT_FALSE(Date::parse("2024/01/01"));
+    EXPECT_FALSE(Date::parse("2024-01-01 "));
+    EXPECT_FALSE(Date::parse("20x4-01-01"));
+    EXPECT_FALSE(Date::parse("+024-01-01"));
+}
+
+TEST(DateTest, LeapYears) {
+    EXPECT_TRUE(Date::parse("2024-02-29"));
+    EXPECT_TRUE(Date::parse("2000-02-29"));
+    EXPECT_FALSE(Date::parse("2023-02-29"));
+    EXPECT_FALSE(Date::parse("1900-02-29"));
+    EXPECT_EQ(parsed("2024-03-01").days() - parsed("2024-02-28").days(), 2);
+}
+
+TEST(DateTest, FormatRoundTrip) {
+    for (const char* text : {"1970-01-01", "1999-12-31", "2000-02-29", "2024-02-29", "2038-01-19", "0001-01-01",
+                             "9999-12-31"}) {
+        EXPECT_EQ(parsed(text).toString(), text);
+    }
+    for (int32_t days = -1000; days <= 30000; days += 37) {
+        Date date = Date::fromDays(days);
+        EXPECT_EQ(parsed(date.toString()), date);
+    }
+}
+
+TEST(DateTest, NullDate) {
+    Date date;
+    EXPECT_TRUE(date.isNull());
+    EXPECT_EQ(date.toString(), "");
+    EXPECT_LT(date, parsed("0001-01-01"));
+}
+
+TEST(DateTest, AddMonthsClampsToEndOfMonth) {
+    EXPECT_EQ(parsed("2024-01-31").addMonths(1).toString(), "2024-02-29");
+    EXPECT_EQ(parsed("2023-01-31").addMonths(1).toString(), "2023-02-28");
+    EXPECT_EQ(parsed("2024-03-31").addMonths(1).toString(), "2024-04-30");
+    EXPECT_EQ(parsed("2024-02-29").addMonths(12).toString(), "2025-02-28");
+    EXPECT_EQ(parsed("2024-08-31").addMonths(-6).toString(), "2024-02-29");
+}
+
+TEST(DateTest, AddMonthsAcrossYears) {
+    EXPECT_EQ(parsed("2023-11-15").addMonths(3).toString(), "2024-02-15");
+    EXPECT_EQ(parsed("2024-01-15").addMonths(-1).toString(), "2023-12-15");
+    EXPECT_EQ(parsed("2024-05-10").addMonths(0).toString(), "2024-05-10");
+    EXPECT_EQ(parsed("2024-05-10").addMonths(36).toString(), "2027-05-10");
+}
+
+TEST(DateTest, JsonConversion) {
+    EXPECT_EQ(nlohmann::json(parsed("2024-02-29")).dump(), "\"2024-02-29\"");
+    EXPECT_TRUE(nlohmann::json(Date()).is_null());
+
+    EXPECT_EQ(nlohmann::json("2024-02-29").get<Date>(), parsed("2024-02-29"));
+    EXPECT_TRUE(nlohmann::json(nullptr).get<Date>().isNull());
+    EXPECT_TRUE(nlohmann::json("").get<Date>().isNull());
+    EXPECT_THROW(nlohmann::json("2023-02-29").get<Date>(), std::invalid_argument);
+}
+
+TEST(DateTest, PqxxTextConversion) {
+    Date date = parsed("2024-02-29");
+    EXPECT_EQ(pqxx::to_string(date), "2024-02-29");
+    EXPECT_EQ(pqxx::from_string<Date>("2024-02-29"), date);
+    EXPECT_THROW(static_cast<void>(pqxx::from_string<Date>("2024-02-30")), pqxx::conversion_error);
+
+    char small[Date::TEXT_SIZE];
+    EXPECT_THROW(pqxx::string_traits<Date>::into_buf(small, small + sizeof(small), date),
+                 pqxx::conversion_overrun);
+
+    EXPECT_TRUE(pqxx::is_null(Date()));
+    EXPECT_FALSE(pqxx::is_null(date));
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include "login_throttle.h"
+
+// Тесты скользящих окон попыток входа: лимит, затухание предыдущего окна,
+// Retry-After, сброс при успешном входе и очистка устаревших окон
+namespace {
+    using Clock = LoginThrottle::Clock;
+    using std::chrono::seconds;
+
+    LoginThrottle::Settings testSettings() {
+        LoginThrottle::Settings settings;
+        settings.max_attempts_per_ip = 3;
+        settings.max_attempts_per_user = 2;
+        settings.window = seconds(60);
+        settings.sweep_interval = seconds(3600);
+        return settings;
+    }
+}
+
+TEST(LoginThrottleTest, RejectsAfterLimit) {
+    LoginThrottle throttle(testSettings());
+    auto now = Clock::now();
+
+    EXPECT_EQ(throttle.admitIp("10.0.0.1", now).count(), 0);
+    EXPECT_EQ(throttle.admitIp("10.0.0.1", now).count(), 0);
+    EXPECT_EQ(throttle.admitIp("10.0.0.1", now).count(), 0);
+    EXPECT_GT(throttle.admitIp("10.0.0.1", now).count(), 0);
+
+    // Другой IP считается отдельно
+    EXPECT_EQ(throttle.admitIp("10.0.0.2", now).count(), 0);
+}
+
+TEST(LoginThrottleTest, RetryAfterCoversRestOfWindow) {
+    LoginThrottle throttle(testSettings());
+    auto now = Clock::now();
+    for (int i = 0; i < 3; ++i) {
+        throttle.admitIp("10.0.0.1", now);
+    }
+
+    auto retry_after = throttle.admitIp("10.0.0.1", now);
+    EXPECT_GE(retry_after.count(), 60);
+    EXPECT_LE(retry_after.count(), 120);
+    EXPECT_EQ(throttle.admitIp("10.0.0.1", now + retry_after).count(), 0);
+}
+
+TEST(LoginThrottleTest, PreviousWindowDecays) {
+    LoginThrottle throttle(testSettings());
+    auto start = Clock::now();
+    for (int i = 0; i < 3; ++i) {
+        throttle.admitIp("10.0.0.1", start);
+    }
+
+    // В начале следующего окна предыдущее учитывается почти полностью:
+    // оценка 3 * 59/60 ≈ 2.95 допускает ещё одну попытку, но не две
+    EXPECT_EQ(throttle.admitIp("10.0.0.1", start + seconds(61)).count(), 0);
+    EXPECT_GT(throttle.admitIp("10.0.0.1", start + seconds(61)).count(), 0);
+    // Ближе к концу — лишь частично
+    EXPECT_EQ(throttle.admitIp("10.0.0.1", start + seconds(110)).count(), 0);
+    // Через два периода окно пустое
+    EXPECT_EQ(throttle.admitIp("10.0.0.2", start + seconds(200)).count(), 0);
+}
+
+TEST(LoginThrottleTest, SuccessfulLoginIsForgiven) {
+    LoginThrottle throttle(testSettings());
+    auto now = Clock::now();
+
+    EXPECT_EQ(throttle.admitUser("admin", now).count(), 0);
+    EXPECT_EQ(throttle.admitUser("admin", now).count(), 0);
+    EXPECT_GT(throttle.admitUser("admin", now).count(), 0);
+
+    throttle.forgive("10.0.0.1", "admin");
+    EXPECT_EQ(throttle.admitUser("admin", now).count(), 0);
+}
+
+TEST(LoginThrottleTest, SweepRemovesStaleWindows) {
+    LoginThrottle throttle(testSettings());
+    auto now = Clock::now();
+    throttle.admitIp("10.0.0.1", now);
+    throttle.admitUser("admin", now);
+    throttle.admitIp("10.0.0.2", now + seconds(100));
+
+    EXPECT_EQ(throttle.trackedKeys(), 3u);
+    EXPECT_EQ(throttle.sweep(now + seconds(130)), 2u);
+    EXPECT_EQ(throttle.trackedKeys(), 1u);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
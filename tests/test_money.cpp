@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include "money.h"
+#include <limits>
+
+// Тесты Money: разбор десятичной записи с округлением, вывод, отрицательные суммы,
+// границы JSON и преобразования pqxx
+namespace {
+    Money parsed(std::string_view text) {
+        auto money = Money::parse(text);
+        EXPECT_TRUE(money.has_value()) << text;
+        return money.value_or(Money());
+    }
+}
+
+TEST(MoneyTest, ParsesDecimalText) {
+    EXPECT_EQ(parsed("123.45").cents(), 12345);
+    EXPECT_EQ(parsed("123").cents(), 12300);
+    EXPECT_EQ(parsed("123.4").cents(), 12340);
+    EXPECT_EQ(parsed("0.05").cents(), 5);
+    EXPECT_EQ(parsed(".5").cents(), 50);
+    EXPECT_EQ(parsed("7.").cents(), 700);
+    EXPECT_EQ(parsed("+1.00").cents(), 100);
+    EXPECT_EQ(parsed("9999999999999999.99").cents(), 999999999999999999);
+}
+
+TEST(MoneyTest, RejectsMalformedText) {
+    EXPECT_FALSE(Money::parse(""));
+    EXPECT_FALSE(Money::parse("-"));
+    EXPECT_FALSE(Money::parse("."));
+    EXPECT_FALSE(Money::parse("1,50"));
+    EXPECT_FALSE(Money::parse("1.5.0"));
+    EXPECT_FALSE(Money::parse("12a"));
+    EXPECT_FALSE(Money::parse(" 12"));
+    EXPECT_FALSE(Money::parse("1e3"));
+    // Больше 16 цифр целой части
+    EXPECT_FALSE(Money::parse("10000000000000000"));
+}
+
+TEST(MoneyTest, RoundsHalfAwayFromZero) {
+    EXPECT_EQ(parsed("0.005").cents(), 1);
+    EXPECT_EQ(parsed("0.0049").cents(), 0);
+    EXPECT_EQ(parsed("1.995").cents(), 200);
+    EXPECT_EQ(parsed("1.99499").cents(), 199);
+    EXPECT_EQ(parsed("-0.005").cents(), -1);
+    EXPECT_EQ(parsed("-1.995").cents(), -200);
+
+    EXPECT_EQ(Money::fromDouble(0.125).cents(), 13);
+    EXPECT_EQ(Money::fromDouble(-0.125).cents(), -13);
+    EXPECT_EQ(Money::fromDouble(19.99).cents(), 1999);
+}
+
+TEST(MoneyTest, NegativeAmounts) {
+    EXPECT_EQ(parsed("-123.45").cents(), -12345);
+    EXPECT_EQ(parsed("-0.50").toString(), "-0.50");
+    EXPECT_EQ(Money::fromCents(-5).toString(), "-0.05");
+    EXPECT_EQ((parsed("10.00") - parsed("10.01")).toString(), "-0.01");
+}
+
+TEST(MoneyTest, FormatsTwoFractionDigits) {
+    EXPECT_EQ(Money().toString(), "0.00");
+    EXPECT_EQ(Money::fromCents(7).toString(), "0.07");
+    EXPECT_EQ(Money::fromCents(12340).toString(), "123.40");
+    EXPECT_EQ(Money::fromCents(std::numeric_limits<int64_t>::max()).toString(), "92233720368547758.07");
+    EXPECT_EQ(Money::fromCents(std::numeric_limits<int64_t>::min()).toString(), "-92233720368547758.08");
+    EXPECT_EQ(Money::fromCents(std::numeric_limits<int64_t>::min()).toString().size(), Money::MAX_TEXT_SIZE);
+}
+
+TEST(MoneyTest, FormatParseRoundTrip) {
+    for (int64_t cents : {int64_t{0}, int64_t{1}, int64_t{-1}, int64_t{99}, int64_t{-100}, int64_t{123456789},
+                          int64_t{-999999999999999999}}) {
+        EXPECT_EQ(parsed(Money::fromCents(cents).toString()).cents(), cents);
+    }
+}
+
+TEST(MoneyTest, ExactArithmetic) {
+    Money sum;
+    for (int i = 0; i < 10; ++i) {
+        sum += parsed("0.10");
+    }
+    EXPECT_EQ(sum, parsed("1.00"));
+    EXPECT_EQ((parsed("0.10") + parsed("0.20")).toString(), "0.30");
+}
+
+TEST(MoneyTest, JsonInput) {
+    EXPECT_EQ(nlohmann::json("12.34").get<Money>().cents(), 1234);
+    EXPECT_EQ(nlohmann::json(12.345).get<Money>().cents(), 1235);
+    EXPECT_EQ(nlohmann::json(-3).get<Money>().cents(), -300);
+    EXPECT_EQ(nlohmann::json(uint64_t{5}).get<Money>().cents(), 500);
+    EXPECT_THROW(nlohmann::json("12,34").get<Money>(), std::invalid_argument);
+}
+
+TEST(MoneyTest, JsonInputRejectsOutOfRange) {
+    // Без проверки умножение на 100 переполнило бы int64
+    EXPECT_THROW(nlohmann::json(int64_t{10'000'000'000'000'000}).get<Money>(), std::invalid_argument);
+    EXPECT_THROW(nlohmann::json(int64_t{-10'000'000'000'000'000}).get<Money>(), std::invalid_argument);
+    EXPECT_THROW(nlohmann::json(std::numeric_limits<int64_t>::max()).get<Money>(), std::invalid_argument);
+    EXPECT_THROW(nlohmann::json(std::numeric_limits<uint64_t>::max()).get<Money>(), std::invalid_argument);
+    EXPECT_THROW(nlohmann::json(1e16).get<Money>(), std::invalid_argument);
+    EXPECT_EQ(nlohmann::json(int64_t{9'999'999'999'999'999}).get<Money>().cents(), 999'999'999'999'999'900);
+}
+
+TEST(MoneyTest, JsonOutputIsExactDecimal) {
+    EXPECT_EQ(nlohmann::json(parsed("0.30")).dump(), "0.3");
+    EXPECT_EQ(nlohmann::json(parsed("123.45")).dump(), "123.45");
+    EXPECT_EQ(nlohmann::json(parsed("-0.07")).dump(), "-0.07");
+    // Максимум DECIMAL(12,2)
+    EXPECT_EQ(nlohmann::json(parsed("9999999999.99")).dump(), "9999999999.99");
+    for (int64_t cents = -100000; cents <= 100000; cents += 7) {
+        Money money = Money::fromCents(cents);
+        EXPECT_EQ(nlohmann::json::parse(nlohmann::json(money).dump()).get<Money>(), money);
+    }
+}
+
+TEST(MoneyTest, PqxxTextConversion) {
+    EXPECT_EQ(pqxx::to_string(parsed("-12.30")), "-12.30");
+    EXPECT_EQ(pqxx::from_string<Money>("150.00"), parsed("150"));
+    EXPECT_THROW(static_cast<void>(pqxx::from_string<Money>("NaN")), pqxx::conversion_error);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
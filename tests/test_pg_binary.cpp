@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+#include "pg_binary.h"
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <string>
+
+// Тесты декодеров бинарного формата PostgreSQL на известных байтах сетевого представления
+// и pg_binary::Result на PGresult, собранном без сервера (PQmakeEmptyPGresult)
+namespace {
+    void appendUint16(std::string& out, uint16_t value) {
+        out.push_back(static_cast<char>(value >> 8));
+        out.push_back(static_cast<char>(value & 0xFF));
+    }
+
+    void appendUint32(std::string& out, uint32_t value) {
+        appendUint16(out, static_cast<uint16_t>(value >> 16));
+        appendUint16(out, static_cast<uint16_t>(value & 0xFFFF));
+    }
+
+    // numeric: ndigits, weight, sign, dscale, затем цифры по основанию 10000
+    std::string numericBytes(int16_t weight, uint16_t sign, uint16_t dscale, std::initializer_list<uint16_t> digits) {
+        std::string out;
+        appendUint16(out, static_cast<uint16_t>(digits.size()));
+        appendUint16(out, static_cast<uint16_t>(weight));
+        appendUint16(out, sign);
+        appendUint16(out, dscale);
+        for (uint16_t digit : digits) {
+            appendUint16(out, digit);
+        }
+        return out;
+    }
+
+    Money numeric(const std::string& bytes) {
+        return pg_binary::decodeNumeric(bytes.data(), static_cast<int>(bytes.size()));
+    }
+
+    std::string dateBytes(int32_t days_since_2000) {
+        std::string out;
+        appendUint32(out, static_cast<uint32_t>(days_since_2000));
+        return out;
+    }
+
+    Date date(const std::string& bytes) {
+        return pg_binary::decodeDate(bytes.data(), static_cast<int>(bytes.size()));
+    }
+
+    const uint16_t POS = 0x0000;
+    const uint16_t NEG = 0x4000;
+    const uint16_t NAN_SIGN = 0xC000;
+}
+
+TEST(PgBinaryTest, DecodesInt4) {
+    std::string bytes;
+    appendUint32(bytes, 0x0001E240);
+    EXPECT_EQ(pg_binary::decodeInt4(bytes.data(), 4), 123456);
+    bytes.clear();
+    appendUint32(bytes, 0xFFFFFFFF);
+    EXPECT_EQ(pg_binary::decodeInt4(bytes.data(), 4), -1);
+    EXPECT_THROW(pg_binary::decodeInt4(bytes.data(), 2), std::runtime_error);
+}
+
+TEST(PgBinaryTest, DecodesInt8) {
+    std::string bytes;
+    appendUint32(bytes, 0x00000001);
+    appendUint32(bytes, 0x00000002);
+    EXPECT_EQ(pg_binary::decodeInt8(bytes.data(), 8), (int64_t{1} << 32) + 2);
+    bytes.clear();
+    appendUint32(bytes, 0xFFFFFFFF);
+    appendUint32(bytes, 0xFFFFFFFE);
+    EXPECT_EQ(pg_binary::decodeInt8(bytes.data(), 8), -2);
+    EXPECT_THROW(pg_binary::decodeInt8(bytes.data(), 4), std::runtime_error);
+}
+
+TEST(PgBinaryTest, DecodesNumeric) {
+    // 123.45: цифры 123 | 4500, weight 0
+    EXPECT_EQ(numeric(numericBytes(0, POS, 2, {123, 4500})).cents(), 12345);
+    // 12345678.9: 1234 | 5678 | 9000, weight 1
+    EXPECT_EQ(numeric(numericBytes(1, POS, 1, {1234, 5678, 9000})).cents(), 1234567890);
+    // 20000: цифра 2 с weight 1, хвостовые нули не передаются
+    EXPECT_EQ(numeric(numericBytes(1, POS, 0, {2})).cents(), 2000000);
+    // Ноль: ndigits = 0
+    EXPECT_EQ(numeric(numericBytes(0, POS, 2, {})).cents(), 0);
+}
+
+TEST(PgBinaryTest, DecodesNegativeNumeric) {
+    EXPECT_EQ(numeric(numericBytes(0, NEG, 2, {123, 4500})).cents(), -12345);
+    // -0.07: weight -1, цифра 700
+    EXPECT_EQ(numeric(numericBytes(-1, NEG, 2, {700})).cents(), -7);
+}
+
+TEST(PgBinaryTest, DecodesNumericBelowOne) {
+    // 0.005: weight -1, цифра 50 (0.0050) -> округление до 0.01
+    EXPECT_EQ(numeric(numericBytes(-1, POS, 3, {50})).cents(), 1);
+    // 0.0049 -> 0.00
+    EXPECT_EQ(numeric(numericBytes(-1, POS, 4, {49})).cents(), 0);
+    // 0.00001: weight -2, до копеек не доходит
+    EXPECT_EQ(numeric(numericBytes(-2, POS, 5, {1000})).cents(), 0);
+}
+
+TEST(PgBinaryTest, RoundsNumericHalfAwayFromZero) {
+    // 1.995 -> 2.00, -1.995 -> -2.00, 1.9949 -> 1.99
+    EXPECT_EQ(numeric(numericBytes(0, POS, 3, {1, 9950})).cents(), 200);
+    EXPECT_EQ(numeric(numericBytes(0, NEG, 3, {1, 9950})).cents(), -200);
+    EXPECT_EQ(numeric(numericBytes(0, POS, 4, {1, 9949})).cents(), 199);
+    // Совпадает с Money::parse для той же записи
+    EXPECT_EQ(numeric(numericBytes(0, POS, 3, {1, 9950})), *Money::parse("1.995"));
+}
+
+TEST(PgBinaryTest, NumericWeightLimit) {
+    // weight 3: 9999 9999 9999 9999.99 — ещё помещается
+    EXPECT_EQ(numeric(numericBytes(3, POS, 2, {9999, 9999, 9999, 9999, 9900})).cents(), 999999999999999999);
+    // weight 4 (>= 10^16) — отказ, а не переполнение
+    EXPECT_THROW(numeric(numericBytes(4, POS, 0, {1})), std::runtime_error);
+    EXPECT_THROW(numeric(numericBytes(100, NEG, 0, {1})), std::runtime_error);
+}
+
+TEST(PgBinaryTest, RejectsMalformedNumeric) {
+    EXPECT_THROW(numeric(numericBytes(0, NAN_SIGN, 0, {})), std::runtime_error);
+    std::string bytes = numericBytes(0, POS, 2, {123, 4500});
+    EXPECT_THROW(pg_binary::decodeNumeric(bytes.data(), static_cast<int>(bytes.size()) - 2), std::runtime_error);
+    EXPECT_THROW(pg_binary::decodeNumeric(bytes.data(), 6), std::runtime_error);
+}
+
+TEST(PgBinaryTest, DecodesDate) {
+    EXPECT_EQ(date(dateBytes(0)), *Date::parse("2000-01-01"));
+    EXPECT_EQ(date(dateBytes(59)), *Date::parse("2000-02-29"));
+    EXPECT_EQ(date(dateBytes(-1)), *Date::parse("1999-12-31"));
+    EXPECT_EQ(date(dateBytes(-10957)), *Date::parse("1970-01-01"));
+    EXPECT_EQ(date(dateBytes(9131)), *Date::parse("2024-12-31"));
+}
+
+TEST(PgBinaryTest, RejectsInfiniteDates) {
+    EXPECT_THROW(date(dateBytes(std::numeric_limits<int32_t>::max())), std::runtime_error);
+    EXPECT_THROW(date(dateBytes(std::numeric_limits<int32_t>::min())), std::runtime_error);
+    EXPECT_THROW(pg_binary::decodeDate("\0\0\0", 3), std::runtime_error);
+}
+
+TEST(PgBinaryTest, ResultMapsNulls) {
+    PGresult* raw = PQmakeEmptyPGresult(nullptr, PGRES_TUPLES_OK);
+    ASSERT_NE(raw, nullptr);
+    PGresAttDesc attrs[3] = {};
+    attrs[0].name = const_cast<char*>("notes");
+    attrs[0].typid = pg_binary::TEXT_OID;
+    attrs[0].format = 1;
+    attrs[1].name = const_cast<char*>("cost");
+    attrs[1].typid = pg_binary::NUMERIC_OID;
+    attrs[1].format = 1;
+    attrs[2].name = const_cast<char*>("next_due_date");
+    attrs[2].typid = pg_binary::DATE_OID;
+    attrs[2].format = 1;
+    ASSERT_TRUE(PQsetResultAttrs(raw, 3, attrs));
+
+    // Строка 0 — значения, строка 1 — NULL (длина -1), строка 2 — пустая строка
+    std::string cost = numericBytes(0, POS, 2, {150});
+    std::string due = dateBytes(0);
+    ASSERT_TRUE(PQsetvalue(raw, 0, 0, const_cast<char*>("ok"), 2));
+    ASSERT_TRUE(PQsetvalue(raw, 0, 1, cost.data(), static_cast<int>(cost.size())));
+    ASSERT_TRUE(PQsetvalue(raw, 0, 2, due.data(), static_cast<int>(due.size())));
+    for (int column = 0; column < 3; ++column) {
+        ASSERT_TRUE(PQsetvalue(raw, 1, column, nullptr, -1));
+    }
+    ASSERT_TRUE(PQsetvalue(raw, 2, 0, const_cast<char*>(""), 0));
+
+    pg_binary::Result result(raw);
+    EXPECT_NO_THROW(result.expectTypes({pg_binary::TEXT_OID, pg_binary::NUMERIC_OID, pg_binary::DATE_OID}));
+    EXPECT_THROW(result.expectTypes({pg_binary::INT4_OID, pg_binary::NUMERIC_OID, pg_binary::DATE_OID}),
+                 std::runtime_error);
+    EXPECT_THROW(result.expectTypes({pg_binary::TEXT_OID}), std::runtime_error);
+
+    EXPECT_EQ(result.text(0, 0), "ok");
+    EXPECT_EQ(result.numeric(0, 1).cents(), 15000);
+    EXPECT_EQ(result.date(0, 2), *Date::parse("2000-01-01"));
+
+    // NULL: text -> "", numeric -> 0, date -> Date()
+    EXPECT_TRUE(result.isNull(1, 0));
+    EXPECT_EQ(result.text(1, 0), "");
+    EXPECT_EQ(result.numeric(1, 1).cents(), 0);
+    EXPECT_TRUE(result.date(1, 2).isNull());
+
+    // Пустая строка от NULL отличается только через isNull
+    EXPECT_FALSE(result.isNull(2, 0));
+    EXPECT_EQ(result.text(2, 0), "");
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
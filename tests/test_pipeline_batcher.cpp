@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+#include "pipeline_batcher.h"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Тесты сбора сегментов pipeline в пакеты: окно, max_batch, распределение результатов
+// и ошибок по сегментам. Вместо runPipeline — подставной исполнитель без сервера
+namespace {
+    using std::chrono::milliseconds;
+
+    pg_binary::PipelineSegment segmentOf(const std::vector<std::string>& queries) {
+        pg_binary::PipelineSegment segment;
+        for (const auto& sql : queries) {
+            segment.queries.push_back({sql, {}});
+        }
+        return segment;
+    }
+
+    // Исполнитель: на каждый запрос сегмента — пустой результат; запрос "fail" — ошибка сегмента
+    class FakeRunner {
+    public:
+        std::mutex mutex;
+        std::vector<size_t> batch_sizes;
+
+        PipelineBatcher::Runner runner() {
+            return [this](const std::vector<const pg_binary::PipelineSegment*>& segments) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    batch_sizes.push_back(segments.size());
+                }
+                std::vector<pg_binary::PipelineOutcome> outcomes(segments.size());
+                for (size_t i = 0; i < segments.size(); ++i) {
+                    for (const auto& query : segments[i]->queries) {
+                        if (query.sql == "fail") {
+                            outcomes[i].error = std::make_exception_ptr(pg_binary::Error("query failed", "42P01"));
+                            outcomes[i].results.clear();
+                            break;
+                        }
+                        outcomes[i].results.emplace_back(PQmakeEmptyPGresult(nullptr, PGRES_TUPLES_OK));
+                    }
+                }
+                return outcomes;
+            };
+        }
+
+        std::vector<size_t> sizes() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return batch_sizes;
+        }
+    };
+
+    PipelineBatcher::Settings settings(milliseconds window, size_t max_batch) {
+        PipelineBatcher::Settings result;
+        result.window = window;
+        result.max_batch = max_batch;
+        return result;
+    }
+}
+
+TEST(PipelineBatcherTest, SingleSegment) {
+    FakeRunner fake;
+    PipelineBatcher batcher(settings(milliseconds(1), 8), fake.runner());
+
+    auto results = batcher.execute(segmentOf({"a", "b", "c"}));
+    EXPECT_EQ(results.size(), 3u);
+    EXPECT_EQ(fake.sizes(), std::vector<size_t>{1});
+}
+
+TEST(PipelineBatcherTest, WaitsForWindowBeforeSending) {
+    FakeRunner fake;
+    PipelineBatcher batcher(settings(milliseconds(30), 8), fake.runner());
+
+    auto start = std::chrono::steady_clock::now();
+    batcher.execute(segmentOf({"a"}));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, milliseconds(30));
+}
+
+TEST(PipelineBatcherTest, ConcurrentSegmentsShareBatch) {
+    FakeRunner fake;
+    PipelineBatcher batcher(settings(milliseconds(500), 4), fake.runner());
+
+    // Полный пакет уходит, не дожидаясь окна
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    std::vector<size_t> result_sizes(4);
+    for (size_t i = 0; i < 4; ++i) {
+        threads.emplace_back([&batcher, &result_sizes, i]() {
+            std::vector<std::string> queries(i + 1, "select");
+            result_sizes[i] = batcher.execute(segmentOf(queries)).size();
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_LT(std::chrono::steady_clock::now() - start, milliseconds(500));
+    EXPECT_EQ(fake.sizes(), std::vector<size_t>{4});
+    // Каждый получил результаты своего сегмента
+    for (size_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(result_sizes[i], i + 1);
+    }
+}
+
+TEST(PipelineBatcherTest, SplitsByMaxBatch) {
+    FakeRunner fake;
+    PipelineBatcher batcher(settings(milliseconds(100), 2), fake.runner());
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 5; ++i) {
+        threads.emplace_back([&batcher]() { batcher.execute(segmentOf({"select"})); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    size_t total = 0;
+    for (size_t size : fake.sizes()) {
+        EXPECT_LE(size, 2u);
+        total += size;
+    }
+    EXPECT_EQ(total, 5u);
+    EXPECT_GE(fake.sizes().size(), 3u);
+}
+
+TEST(PipelineBatcherTest, SegmentErrorStaysInSegment) {
+    FakeRunner fake;
+    PipelineBatcher batcher(settings(milliseconds(200), 2), fake.runner());
+
+    std::atomic<bool> ok_succeeded{false};
+    std::string failed_state;
+    std::thread ok([&]() { ok_succeeded = batcher.execute(segmentOf({"select"})).size() == 1; });
+    std::thread failing([&]() {
+        try {
+            batcher.execute(segmentOf({"select", "fail"}));
+        } catch (const pg_binary::Error& e) {
+            failed_state = e.sqlstate();
+        }
+    });
+    ok.join();
+    failing.join();
+
+    EXPECT_TRUE(ok_succeeded);
+    EXPECT_EQ(failed_state, "42P01");
+    EXPECT_EQ(fake.sizes(), std::vector<size_t>{2});
+}
+
+TEST(PipelineBatcherTest, RunnerFailureReachesEverySegment) {
+    PipelineBatcher batcher(settings(milliseconds(200), 3),
+                            [](const std::vector<const pg_binary::PipelineSegment*>&)
+                                -> std::vector<pg_binary::PipelineOutcome> {
+                                throw pg_binary::Error("connection lost", "");
+                            });
+
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 3; ++i) {
+        threads.emplace_back([&]() {
+            try {
+                batcher.execute(segmentOf({"select"}));
+            } catch (const pg_binary::Error&) {
+                ++failures;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(failures, 3);
+}
+
+TEST(PipelineBatcherTest, OutcomeCountMismatchFailsBatch) {
+    PipelineBatcher batcher(settings(milliseconds(1), 8),
+                            [](const std::vector<const pg_binary::PipelineSegment*>&) {
+                                return std::vector<pg_binary::PipelineOutcome>();
+                            });
+    EXPECT_THROW(batcher.execute(segmentOf({"select"})), std::runtime_error);
+}
+
+TEST(PipelineBatcherTest, ConfigureChangesMaxBatch) {
+    FakeRunner fake;
+    PipelineBatcher batcher(settings(milliseconds(500), 8), fake.runner());
+    batcher.configure(settings(milliseconds(500), 1));
+
+    // max_batch = 1: сегмент уходит сразу, без окна
+    auto start = std::chrono::steady_clock::now();
+    batcher.execute(segmentOf({"select"}));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, milliseconds(500));
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include "rate_limiter.h"
+
+// Тесты корзин жетонов: выбор группы по префиксу, ёмкость, ленивое пополнение,
+// Retry-After и удаление наполнившихся корзин
+namespace {
+    using Clock = RateLimiter::Clock;
+    using std::chrono::milliseconds;
+    using std::chrono::seconds;
+
+    std::vector<RateLimiter::Group> testGroups() {
+        return {
+            {"history", "/api/service-history", 2.0, 4.0},
+            {"api", "/api/", 10.0, 10.0},
+        };
+    }
+}
+
+TEST(RateLimiterTest, FirstMatchingGroupWins) {
+    RateLimiter limiter(testGroups(), seconds(3600));
+
+    ASSERT_NE(limiter.match("/api/service-history"), nullptr);
+    EXPECT_EQ(limiter.match("/api/service-history")->name, "history");
+    EXPECT_EQ(limiter.match("/api/devices")->name, "api");
+    EXPECT_EQ(limiter.match("/metrics"), nullptr);
+}
+
+TEST(RateLimiterTest, BurstThenRetryAfter) {
+    RateLimiter limiter(testGroups(), seconds(3600));
+    const auto& group = *limiter.match("/api/service-history");
+    auto now = Clock::now();
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(limiter.acquire(group, "ip:10.0.0.1", now).count(), 0);
+    }
+    EXPECT_EQ(limiter.acquire(group, "ip:10.0.0.1", now).count(), 1);
+
+    // Другие клиенты и группы — отдельные корзины
+    EXPECT_EQ(limiter.acquire(group, "ip:10.0.0.2", now).count(), 0);
+    EXPECT_EQ(limiter.acquire(*limiter.match("/api/devices"), "ip:10.0.0.1", now).count(), 0);
+}
+
+TEST(RateLimiterTest, RefillsLazily) {
+    RateLimiter limiter(testGroups(), seconds(3600));
+    const auto& group = *limiter.match("/api/service-history");
+    auto now = Clock::now();
+
+    for (int i = 0; i < 4; ++i) {
+        limiter.acquire(group, "user:admin", now);
+    }
+    EXPECT_GT(limiter.acquire(group, "user:admin", now + milliseconds(400)).count(), 0);
+    EXPECT_EQ(limiter.acquire(group, "user:admin", now + milliseconds(600)).count(), 0);
+
+    // Пополнение не превышает ёмкость корзины
+    auto later = now + seconds(3600);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(limiter.acquire(group, "user:admin", later).count(), 0);
+    }
+    EXPECT_GT(limiter.acquire(group, "user:admin", later).count(), 0);
+}
+
+TEST(RateLimiterTest, SweepRemovesFullBuckets) {
+    RateLimiter limiter(testGroups(), seconds(3600));
+    const auto& group = *limiter.match("/api/service-history");
+    auto now = Clock::now();
+
+    limiter.acquire(group, "ip:10.0.0.1", now);
+    limiter.acquire(group, "ip:10.0.0.2", now + seconds(10));
+    EXPECT_EQ(limiter.trackedBuckets(), 2u);
+
+    // Один жетон при скорости 2/с восстанавливается за 0.5 с
+    EXPECT_EQ(limiter.sweep(now + seconds(1)), 1u);
+    EXPECT_EQ(limiter.trackedBuckets(), 1u);
+}
+
+TEST(RateLimiterTest, RejectsInvalidGroup) {
+    EXPECT_THROW(RateLimiter({{"bad", "/api/", 0.0, 1.0}}), std::invalid_argument);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include "request_arena.h"
+#include "metrics.h"
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Тесты арены запроса: ресурс вне и внутри Scope, сброс в конце запроса,
+// вложенные Scope, метрики выделений и выхода за начальный буфер
+namespace {
+    double metricValue(const std::string& line_prefix) {
+        std::istringstream lines(MetricsRegistry::getInstance().format());
+        std::string line;
+        while (std::getline(lines, line)) {
+            if (line.rfind(line_prefix + " ", 0) == 0) {
+                return std::stod(line.substr(line_prefix.size() + 1));
+            }
+        }
+        return 0.0;
+    }
+}
+
+TEST(RequestArenaTest, DefaultResourceOutsideScope) {
+    EXPECT_EQ(RequestArena::resource(), std::pmr::get_default_resource());
+    {
+        RequestArena::Scope scope;
+        EXPECT_NE(RequestArena::resource(), std::pmr::get_default_resource());
+    }
+    EXPECT_EQ(RequestArena::resource(), std::pmr::get_default_resource());
+}
+
+TEST(RequestArenaTest, ReleasedAtEndOfRequest) {
+    const void* first = nullptr;
+    {
+        RequestArena::Scope scope;
+        std::pmr::string text(RequestArena::resource());
+        text.assign(1000, 'x');
+        first = text.data();
+    }
+    {
+        // Следующий запрос потока получает тот же буфер с начала
+        RequestArena::Scope scope;
+        std::pmr::string text(RequestArena::resource());
+        text.assign(1000, 'y');
+        EXPECT_EQ(text.data(), first);
+    }
+}
+
+TEST(RequestArenaTest, NestedScopeKeepsOuterAllocations) {
+    RequestArena::Scope outer;
+    std::pmr::vector<int> values(RequestArena::resource());
+    values.assign(100, 7);
+    {
+        RequestArena::Scope inner;
+        std::pmr::vector<int> other(RequestArena::resource());
+        other.assign(100, 1);
+    }
+    std::pmr::vector<int> after(RequestArena::resource());
+    after.assign(100, 2);
+    EXPECT_EQ(std::vector<int>(values.begin(), values.end()), std::vector<int>(100, 7));
+    EXPECT_NE(static_cast<const void*>(after.data()), static_cast<const void*>(values.data()));
+}
+
+TEST(RequestArenaTest, RecordsMetrics) {
+    double allocations = metricValue("request_arena_allocations_total");
+    double bytes = metricValue("request_arena_bytes_total");
+    double requests = metricValue("request_arena_requests_total{overflow=\"false\"}");
+    double overflowed = metricValue("request_arena_requests_total{overflow=\"true\"}");
+    {
+        RequestArena::Scope scope;
+        std::pmr::memory_resource* resource = RequestArena::resource();
+        void* first = resource->allocate(64, alignof(std::max_align_t));
+        void* second = resource->allocate(128, alignof(std::max_align_t));
+        resource->deallocate(second, 128, alignof(std::max_align_t));
+        resource->deallocate(first, 64, alignof(std::max_align_t));
+    }
+    EXPECT_EQ(metricValue("request_arena_allocations_total"), allocations + 2);
+    EXPECT_EQ(metricValue("request_arena_bytes_total"), bytes + 192);
+    EXPECT_EQ(metricValue("request_arena_requests_total{overflow=\"false\"}"), requests + 1);
+
+    {
+        RequestArena::Scope scope;
+        std::pmr::string big(RequestArena::resource());
+        big.assign(RequestArena::INITIAL_SIZE * 2, 'z');
+    }
+    EXPECT_EQ(metricValue("request_arena_requests_total{overflow=\"true\"}"), overflowed + 1);
+
+    // Scope без выделений метрики не пишет
+    { RequestArena::Scope scope; }
+    EXPECT_EQ(metricValue("request_arena_requests_total{overflow=\"false\"}"), requests + 1);
+}
+
+TEST(RequestArenaTest, SeparateArenaPerThread) {
+    RequestArena::Scope scope;
+    std::pmr::memory_resource* main_resource = RequestArena::resource();
+    std::pmr::memory_resource* worker_resource = nullptr;
+    std::thread worker([&worker_resource]() {
+        RequestArena::Scope worker_scope;
+        worker_resource = RequestArena::resource();
+    });
+    worker.join();
+    EXPECT_NE(main_resource, worker_resource);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
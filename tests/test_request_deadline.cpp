@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include "request_deadline.h"
+
+// Тесты срока запроса: Scope потока, вложенность, остаток для statement_timeout
+namespace {
+    using Clock = RequestDeadline::Clock;
+    using std::chrono::milliseconds;
+}
+
+TEST(RequestDeadlineTest, NoDeadlineOutsideScope) {
+    EXPECT_FALSE(RequestDeadline::current().has_value());
+    EXPECT_FALSE(RequestDeadline::remaining().has_value());
+    EXPECT_FALSE(RequestDeadline::expired());
+    EXPECT_NO_THROW(RequestDeadline::check("test"));
+}
+
+TEST(RequestDeadlineTest, RemainingAndExpiry) {
+    auto now = Clock::now();
+    RequestDeadline::Scope scope(now + milliseconds(500));
+
+    EXPECT_EQ(RequestDeadline::remaining(now)->count(), 500);
+    EXPECT_FALSE(RequestDeadline::expired(now));
+    EXPECT_TRUE(RequestDeadline::expired(now + milliseconds(500)));
+    // Истёкший срок не превращается в statement_timeout = 0 (без ограничения)
+    EXPECT_EQ(RequestDeadline::remaining(now + milliseconds(900))->count(), 1);
+}
+
+TEST(RequestDeadlineTest, CheckThrowsWithStage) {
+    RequestDeadline::Scope scope(Clock::now() - milliseconds(1));
+    try {
+        RequestDeadline::check("serialization");
+        FAIL() << "DeadlineExceeded expected";
+    } catch (const DeadlineExceeded& e) {
+        EXPECT_STREQ(e.what(), "serialization");
+    }
+}
+
+TEST(RequestDeadlineTest, NestedScopeRestoresOuter) {
+    auto outer = Clock::now() + milliseconds(1000);
+    RequestDeadline::Scope outer_scope(outer);
+    {
+        RequestDeadline::Scope inner_scope(std::nullopt);
+        EXPECT_FALSE(RequestDeadline::current().has_value());
+    }
+    ASSERT_TRUE(RequestDeadline::current().has_value());
+    EXPECT_EQ(*RequestDeadline::current(), outer);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include "simd_kernels.h"
+#include <limits>
+#include <random>
+#include <vector>
+
+// Тесты векторных ядер: каждая реализация должна совпадать со скалярной,
+// включая хвост массива (длины не кратные ширине вектора)
+namespace {
+
+    struct Columns {
+        std::vector<int32_t> days;
+        std::vector<int32_t> devices;
+        std::vector<int32_t> services;
+        std::vector<int64_t> costs;
+    };
+
+    Columns makeColumns(size_t rows, unsigned seed) {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int32_t> day(18000, 19000);
+        std::uniform_int_distribution<int32_t> device(-1, 70);
+        std::uniform_int_distribution<int32_t> service(1, 10);
+        std::uniform_int_distribution<int64_t> cost(-1000, 1000000);
+
+        Columns columns;
+        for (size_t i = 0; i < rows; ++i) {
+            columns.days.push_back(day(rng));
+            columns.devices.push_back(device(rng));
+            columns.services.push_back(service(rng));
+            columns.costs.push_back(cost(rng));
+        }
+        return columns;
+    }
+
+    const simd_kernels::Isa ALL_ISAS[] = {simd_kernels::Isa::Sse42, simd_kernels::Isa::Avx2};
+
+}
+
+TEST(SimdKernelsTest, CostStatsMatchScalar) {
+    std::vector<uint32_t> bitmap(2, 0);
+    for (int32_t id : {3, 17, 31, 32, 40}) {
+        bitmap[id >> 5] |= 1u << (id & 31);
+    }
+
+    const auto& scalar = simd_kernels::kernels(simd_kernels::Isa::Scalar);
+    for (size_t rows : {0u, 1u, 7u, 8u, 9u, 1000u, 4099u}) {
+        Columns c = makeColumns(rows, static_cast<unsigned>(rows));
+
+        simd_kernels::RowFilter filter;
+        filter.from_day = 18200;
+        filter.to_day = 18800;
+        filter.device_bitmap = bitmap.data();
+        filter.device_bitmap_words = bitmap.size();
+
+        auto expected = scalar.cost_stats(c.days.data(), c.devices.data(), c.services.data(),
+                                          c.costs.data(), rows, filter);
+        for (auto isa : ALL_ISAS) {
+            auto actual = simd_kernels::kernels(isa).cost_stats(c.days.data(), c.devices.data(), c.services.data(),
+                                                                c.costs.data(), rows, filter);
+            EXPECT_EQ(actual.count, expected.count) << rows;
+            EXPECT_EQ(actual.sum, expected.sum) << rows;
+            EXPECT_EQ(actual.min, expected.min) << rows;
+            EXPECT_EQ(actual.max, expected.max) << rows;
+        }
+    }
+}
+
+TEST(SimdKernelsTest, SelectRowsMatchScalar) {
+    const auto& scalar = simd_kernels::kernels(simd_kernels::Isa::Scalar);
+    Columns c = makeColumns(1027, 7);
+
+    std::vector<uint32_t> services(1, (1u << 2) | (1u << 5));
+    simd_kernels::RowFilter filter;
+    filter.from_day = 18100;
+    filter.service_bitmap = services.data();
+    filter.service_bitmap_words = services.size();
+
+    std::vector<uint32_t> expected(c.days.size());
+    size_t expected_count = scalar.select_rows(c.days.data(), c.devices.data(), c.services.data(),
+                                               c.days.size(), filter, 100, expected.data());
+    expected.resize(expected_count);
+    ASSERT_GT(expected_count, 0u);
+
+    for (auto isa : ALL_ISAS) {
+        std::vector<uint32_t> actual(c.days.size());
+        size_t count = simd_kernels::kernels(isa).select_rows(c.days.data(), c.devices.data(), c.services.data(),
+                                                              c.days.size(), filter, 100, actual.data());
+        actual.resize(count);
+        EXPECT_EQ(actual, expected);
+    }
+}
+
+TEST(SimdKernelsTest, CountBeforeSkipsNullDates) {
+    const int32_t null_day = std::numeric_limits<int32_t>::min();
+    std::vector<int32_t> due = {null_day, 100, 199, 200, 201, null_day, 50, 300, 150, null_day, 10};
+
+    for (auto isa : {simd_kernels::Isa::Scalar, simd_kernels::Isa::Sse42, simd_kernels::Isa::Avx2}) {
+        EXPECT_EQ(simd_kernels::kernels(isa).count_before(due.data(), due.size(), 200, null_day), 5u);
+    }
+}
+
+TEST(SimdKernelsTest, EmptyBitmapSelectsNothing) {
+    Columns c = makeColumns(64, 3);
+    std::vector<uint32_t> bitmap(1, 0);
+    simd_kernels::RowFilter filter;
+    filter.device_bitmap = bitmap.data();
+    filter.device_bitmap_words = bitmap.size();
+
+    auto stats = simd_kernels::best().cost_stats(c.days.data(), c.devices.data(), c.services.data(),
+                                                 c.costs.data(), c.days.size(), filter);
+    EXPECT_EQ(stats.count, 0u);
+    EXPECT_EQ(stats.sum, 0);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}